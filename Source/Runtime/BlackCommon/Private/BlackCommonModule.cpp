@@ -2,15 +2,19 @@
 
 #include "BlackCommonModule.h"
 #include "Modules/ModuleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Containers/FrameAllocator.h"
 
 void FBlackCommonModule::StartupModule()
 {
     // Code to execute after the module is loaded
+    EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&blk::FFrameArena::EndFrame);
 }
 
 void FBlackCommonModule::ShutdownModule()
 {
     // Code to clean up when the module is unloaded
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
 }
 
 
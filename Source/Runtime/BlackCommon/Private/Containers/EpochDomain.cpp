@@ -0,0 +1,39 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Containers/EpochDomain.h"
+
+namespace blk
+{
+	FEpochDomain::FEpochDomain()
+	{
+		const int32 SlotCount = FMath::Clamp(
+			int32(FMath::RoundUpToPowerOfTwo(FPlatformMisc::NumberOfCoresIncludingHyperthreads())), 1, 64);
+		Slots = MakeUnique<FSlot[]>(SlotCount);
+		SlotShift = 32 - FMath::FloorLog2(SlotCount);
+	}
+
+	FEpochDomain::~FEpochDomain() = default;
+
+	FEpochDomain& FEpochDomain::Get()
+	{
+		static FEpochDomain Domain;
+		return Domain;
+	}
+
+	uint64 FEpochDomain::TryAdvance()
+	{
+		uint64 Current = GetEpoch();
+
+		// Readers pinned at the previous epoch share a parity with the next one
+		const uint32 Previous = uint32((Current + 1) & 1);
+		const int32 SlotCount = 1 << (32 - SlotShift);
+		for (int32 i = 0; i < SlotCount; ++i)
+		{
+			if (Slots[i].Readers[Previous].load(std::memory_order_seq_cst) != 0) return Current;
+		}
+
+		// Losing the race means someone else moved it past Current
+		if (Epoch.compare_exchange_strong(Current, Current + 1, std::memory_order_seq_cst)) return Current + 1;
+		return Current;
+	}
+}
\ No newline at end of file
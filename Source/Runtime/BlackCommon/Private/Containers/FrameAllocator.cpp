@@ -0,0 +1,170 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Containers/FrameAllocator.h"
+#include <atomic>
+
+namespace blk
+{
+	namespace
+	{
+		// Arenas compare it with the frame they were last reset in
+		std::atomic<uint32> GFrameArenaFrame{ 0 };
+	}
+
+	FFrameArena::FFrameArena(SIZE_T InBlockSize)
+		: BlockSize(FMath::Max<SIZE_T>(InBlockSize, sizeof(FBlock) + MinAlignment))
+	{
+	}
+
+	FFrameArena::~FFrameArena()
+	{
+		while (First)
+		{
+			FBlock* Next = First->Next;
+			FMemory::Free(First);
+			First = Next;
+		}
+	}
+
+	FFrameArena& FFrameArena::Get()
+	{
+		static thread_local FFrameArena Arena;
+
+		const uint32 Frame = GFrameArenaFrame.load(std::memory_order_relaxed);
+		if (Arena.Frame != Frame && Arena.OpenMarks == 0 && Arena.LiveAllocations == 0)
+		{
+			Arena.Reset();
+			Arena.Frame = Frame;
+		}
+		return Arena;
+	}
+
+	void FFrameArena::EndFrame()
+	{
+		GFrameArenaFrame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void* FFrameArena::Allocate(SIZE_T Size, uint32 Alignment)
+	{
+		check(FMath::IsPowerOfTwo(Alignment));
+
+		if (Current)
+		{
+			uint8* Result = Align(Top, Alignment);
+			if (Result <= Current->End && SIZE_T(Current->End - Result) >= Size)
+			{
+				Top = Result + Size;
+				LastAllocation = Result;
+				return Result;
+			}
+		}
+
+		return AllocateFromNextBlock(Size, Alignment);
+	}
+
+	bool FFrameArena::TryResize(void* Ptr, SIZE_T NewSize)
+	{
+		uint8* Bytes = static_cast<uint8*>(Ptr);
+		if (Bytes != LastAllocation || SIZE_T(Current->End - Bytes) < NewSize) return false;
+
+		Top = Bytes + NewSize;
+		return true;
+	}
+
+	void* FFrameArena::AllocateFromNextBlock(SIZE_T Size, uint32 Alignment)
+	{
+		// Block data is MinAlignment aligned, larger alignments may need padding in front
+		const SIZE_T Needed = Size + (Alignment > MinAlignment ? Alignment - MinAlignment : 0);
+
+		FBlock* Next = Current ? Current->Next : First;
+		if (!Next || SIZE_T(Next->End - Next->GetData()) < Needed)
+		{
+			// Oversized requests get a block of their own, the smaller one stays further down
+			const SIZE_T DataSize = FMath::Max(BlockSize - sizeof(FBlock), Needed);
+			FBlock* Block = static_cast<FBlock*>(FMemory::Malloc(sizeof(FBlock) + DataSize, MinAlignment));
+			Block->Next = Next;
+			Block->End = Block->GetData() + DataSize;
+			ReservedBytes += sizeof(FBlock) + DataSize;
+
+			if (Current) Current->Next = Block;
+			else First = Block;
+			Next = Block;
+		}
+
+		Current = Next;
+		PeakDepth = FMath::Max(PeakDepth, ++Depth);
+
+		uint8* Result = Align(Current->GetData(), Alignment);
+		Top = Result + Size;
+		LastAllocation = Result;
+		return Result;
+	}
+
+	void FFrameArena::Rewind(FBlock* Block, uint8* InTop, int32 InDepth)
+	{
+		Current = Block;
+		Top = InTop;
+		Depth = InDepth;
+		LastAllocation = nullptr;
+	}
+
+	void FFrameArena::Reset()
+	{
+		check(OpenMarks == 0 && LiveAllocations == 0);
+
+		// Blocks past the deepest one used are what a spike left behind
+		FBlock** Link = &First;
+		for (int32 i = 0; i < PeakDepth && *Link; ++i)
+		{
+			Link = &(*Link)->Next;
+		}
+
+		FBlock* Unused = *Link;
+		*Link = nullptr;
+		while (Unused)
+		{
+			FBlock* Next = Unused->Next;
+			ReservedBytes -= Unused->End - reinterpret_cast<uint8*>(Unused);
+			FMemory::Free(Unused);
+			Unused = Next;
+		}
+
+		Rewind(nullptr, nullptr, 0);
+		PeakDepth = 0;
+	}
+
+	SIZE_T FFrameArena::GetUsedBytes() const
+	{
+		if (!Current) return 0;
+
+		SIZE_T Used = Top - Current->GetData();
+		for (FBlock* Block = First; Block != Current; Block = Block->Next)
+		{
+			Used += Block->End - Block->GetData();
+		}
+		return Used;
+	}
+
+	FFrameArenaMark::FFrameArenaMark(FFrameArena& InArena)
+		: Arena(InArena)
+		, Block(InArena.Current)
+		, Top(InArena.Top)
+		, Depth(InArena.Depth)
+		, LiveAllocations(InArena.LiveAllocations)
+	{
+		++Arena.OpenMarks;
+
+		// An array from before the mark growing in place would run past Top, which the rewind
+		// then hands out again under it
+		Arena.LastAllocation = nullptr;
+	}
+
+	FFrameArenaMark::~FFrameArenaMark()
+	{
+		// Arrays from before the mark may have died, but none made under it may still be alive
+		checkf(Arena.LiveAllocations <= LiveAllocations, TEXT("FFrameAllocator array outlived its FFrameArenaMark"));
+
+		--Arena.OpenMarks;
+		Arena.Rewind(Block, Top, Depth);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Containers/GuillotinePacker.h"
+
+namespace blk
+{
+	void FGuillotinePacker::Init(int32 InWidth, int32 InHeight)
+	{
+		Width = InWidth;
+		Height = InHeight;
+		FreeArea = int64(Width) * Height;
+
+		FreeRects.Reset();
+		if (FreeArea > 0) FreeRects.Add(FIntRect(0, 0, Width, Height));
+	}
+
+	bool FGuillotinePacker::Allocate(int32 InWidth, int32 InHeight, FIntRect& OutRect)
+	{
+		check(InWidth > 0 && InHeight > 0);
+
+		// Best area fit
+		int32 Best = INDEX_NONE;
+		int64 BestLeftover = TNumericLimits<int64>::Max();
+
+		for (int32 i = 0; i < FreeRects.Num(); ++i)
+		{
+			const FIntRect& Free = FreeRects[i];
+			if (Free.Width() < InWidth || Free.Height() < InHeight) continue;
+
+			const int64 Leftover = int64(Free.Width()) * Free.Height() - int64(InWidth) * InHeight;
+			if (Leftover < BestLeftover)
+			{
+				Best = i;
+				BestLeftover = Leftover;
+				if (Leftover == 0) break;
+			}
+		}
+
+		if (Best == INDEX_NONE) return false;
+
+		const FIntRect Free = FreeRects[Best];
+		FreeRects.RemoveAtSwap(Best, 1, EAllowShrinking::No);
+
+		OutRect = FIntRect(Free.Min, Free.Min + FIntPoint(InWidth, InHeight));
+		FreeArea -= int64(InWidth) * InHeight;
+
+		// Split along the shorter leftover axis, so the larger leftover stays in one piece
+		const int32 RightWidth = Free.Width() - InWidth;
+		const int32 BottomHeight = Free.Height() - InHeight;
+		const bool bSplitHorizontal = RightWidth < BottomHeight;
+
+		FIntRect Right, Bottom;
+		if (bSplitHorizontal)
+		{
+			Right = FIntRect(OutRect.Max.X, Free.Min.Y, Free.Max.X, OutRect.Max.Y);
+			Bottom = FIntRect(Free.Min.X, OutRect.Max.Y, Free.Max.X, Free.Max.Y);
+		}
+		else
+		{
+			Right = FIntRect(OutRect.Max.X, Free.Min.Y, Free.Max.X, Free.Max.Y);
+			Bottom = FIntRect(Free.Min.X, OutRect.Max.Y, OutRect.Max.X, Free.Max.Y);
+		}
+
+		if (Right.Area() > 0) FreeRects.Add(Right);
+		if (Bottom.Area() > 0) FreeRects.Add(Bottom);
+		return true;
+	}
+
+	void FGuillotinePacker::Free(const FIntRect& Rect)
+	{
+		check(Rect.Min.X >= 0 && Rect.Min.Y >= 0 && Rect.Max.X <= Width && Rect.Max.Y <= Height);
+
+		FreeArea += int64(Rect.Width()) * Rect.Height();
+
+		// Edge merging cannot always undo every split, so an empty packer starts over
+		if (FreeArea == int64(Width) * Height)
+		{
+			Init(Width, Height);
+			return;
+		}
+
+		MergeFrom(FreeRects.Add(Rect));
+	}
+
+	int64 FGuillotinePacker::GetLargestFreeArea() const
+	{
+		int64 Largest = 0;
+		for (const FIntRect& Free : FreeRects)
+		{
+			Largest = FMath::Max(Largest, int64(Free.Width()) * Free.Height());
+		}
+		return Largest;
+	}
+
+	float FGuillotinePacker::GetFragmentation() const
+	{
+		if (FreeArea == 0) return 0.f;
+		return 1.f - float(double(GetLargestFreeArea()) / double(FreeArea));
+	}
+
+	void FGuillotinePacker::MergeFrom(int32 Index)
+	{
+		bool bMerged = true;
+		while (bMerged)
+		{
+			bMerged = false;
+			FIntRect& Rect = FreeRects[Index];
+
+			for (int32 i = 0; i < FreeRects.Num(); ++i)
+			{
+				if (i == Index) continue;
+				const FIntRect& Other = FreeRects[i];
+
+				// Same column span and touching vertically
+				const bool bVertical = Other.Min.X == Rect.Min.X && Other.Max.X == Rect.Max.X
+					&& (Other.Max.Y == Rect.Min.Y || Other.Min.Y == Rect.Max.Y);
+
+				// Same row span and touching horizontally
+				const bool bHorizontal = Other.Min.Y == Rect.Min.Y && Other.Max.Y == Rect.Max.Y
+					&& (Other.Max.X == Rect.Min.X || Other.Min.X == Rect.Max.X);
+
+				if (!bVertical && !bHorizontal) continue;
+
+				Rect.Min = Rect.Min.ComponentMin(Other.Min);
+				Rect.Max = Rect.Max.ComponentMax(Other.Max);
+
+				// Keeps Index valid when the swapped-in element was the merged rect
+				const int32 Last = FreeRects.Num() - 1;
+				FreeRects.RemoveAtSwap(i, 1, EAllowShrinking::No);
+				if (Index == Last) Index = i;
+
+				bMerged = true;
+				break;
+			}
+		}
+	}
+}
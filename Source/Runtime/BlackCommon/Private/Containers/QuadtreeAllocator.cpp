@@ -0,0 +1,152 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Containers/QuadtreeAllocator.h"
+#include "Math/ArrayIndexing.h"
+
+namespace blk
+{
+	void FQuadtreeAllocator::Init(int32 InWidth, int32 InHeight)
+	{
+		check(InWidth >= 0 && InHeight >= 0 && InWidth <= 0xFFFF && InHeight <= 0xFFFF);
+
+		Width = InWidth;
+		Height = InHeight;
+		FreeTiles = 0;
+
+		const int32 Side = int32(FMath::RoundUpToPowerOfTwo(uint32(FMath::Max3(Width, Height, 1))));
+		LevelCount = int32(FMath::FloorLog2(uint32(Side))) + 1;
+
+		FreeBlocks.SetNum(LevelCount);
+		for (int32 Level = 0; Level < LevelCount; ++Level)
+		{
+			const int32 BlocksPerSide = Side >> Level;
+			FreeBlocks[Level].Init(false, BlocksPerSide * BlocksPerSide);
+		}
+
+		// Tiles past the grid edges are never freed, so blocks holding them never merge up
+		FreeCovered(LevelCount - 1, 0, FIntRect(0, 0, Width, Height), true);
+	}
+
+	bool FQuadtreeAllocator::AllocateTile(FIntPoint& OutTile)
+	{
+		uint32 Block;
+		if (!AllocateBlock(0, Block)) return false;
+
+		OutTile = GetBlockRect(0, Block).Min;
+		return true;
+	}
+
+	void FQuadtreeAllocator::FreeTile(FIntPoint Tile)
+	{
+		check(Tile.X >= 0 && Tile.X < Width && Tile.Y >= 0 && Tile.Y < Height);
+		FreeBlock(0, MortonEncode2D(Tile.X, Tile.Y));
+	}
+
+	bool FQuadtreeAllocator::AllocateRegion(FIntPoint Size, FIntPoint& OutOrigin)
+	{
+		check(Size.X > 0 && Size.Y > 0);
+
+		const uint32 Side = FMath::RoundUpToPowerOfTwo(uint32(FMath::Max(Size.X, Size.Y)));
+		const int32 Level = int32(FMath::FloorLog2(Side));
+
+		uint32 Block;
+		if (Level >= LevelCount || !AllocateBlock(Level, Block)) return false;
+
+		OutOrigin = GetBlockRect(Level, Block).Min;
+
+		// Gives back the slack of non power of two regions
+		FreeCovered(Level, Block, FIntRect(OutOrigin, OutOrigin + Size), false);
+		return true;
+	}
+
+	void FQuadtreeAllocator::FreeRegion(FIntPoint Origin, FIntPoint Size)
+	{
+		FreeCovered(LevelCount - 1, 0, FIntRect(Origin, Origin + Size), true);
+	}
+
+	bool FQuadtreeAllocator::AllocateBlock(int32 Level, uint32& OutBlock)
+	{
+		for (int32 Found = Level; Found < LevelCount; ++Found)
+		{
+			const int32 Index = FreeBlocks[Found].Find(true);
+			if (Index == INDEX_NONE) continue;
+
+			FreeBlocks[Found][Index] = false;
+
+			// Splits down to Level, keeping the first child and freeing its three siblings
+			uint32 Block = uint32(Index);
+			for (int32 Split = Found - 1; Split >= Level; --Split)
+			{
+				Block <<= 2;
+				FreeBlocks[Split][Block + 1] = true;
+				FreeBlocks[Split][Block + 2] = true;
+				FreeBlocks[Split][Block + 3] = true;
+			}
+
+			FreeTiles -= 1 << (Level * 2);
+			OutBlock = Block;
+			return true;
+		}
+
+		return false;
+	}
+
+	void FQuadtreeAllocator::FreeBlock(int32 Level, uint32 Block)
+	{
+		check(!FreeBlocks[Level][Block]);
+		FreeTiles += 1 << (Level * 2);
+
+		while (Level + 1 < LevelCount)
+		{
+			const uint32 First = Block & ~3u;
+
+			bool bSiblingsFree = true;
+			for (uint32 Sibling = First; Sibling < First + 4 && bSiblingsFree; ++Sibling)
+			{
+				bSiblingsFree = Sibling == Block || FreeBlocks[Level][Sibling];
+			}
+			if (!bSiblingsFree) break;
+
+			for (uint32 Sibling = First; Sibling < First + 4; ++Sibling)
+			{
+				FreeBlocks[Level][Sibling] = false;
+			}
+
+			Block >>= 2;
+			++Level;
+		}
+
+		FreeBlocks[Level][Block] = true;
+	}
+
+	void FQuadtreeAllocator::FreeCovered(int32 Level, uint32 Block, const FIntRect& Rect, bool bInside)
+	{
+		const FIntRect Quad = GetBlockRect(Level, Block);
+		const FIntPoint Min = Quad.Min.ComponentMax(Rect.Min);
+		const FIntPoint Max = Quad.Max.ComponentMin(Rect.Max);
+
+		const bool bDisjoint = Min.X >= Max.X || Min.Y >= Max.Y;
+		const bool bCovered = !bDisjoint && Min == Quad.Min && Max == Quad.Max;
+
+		if (bDisjoint || bCovered)
+		{
+			if (bCovered == bInside) FreeBlock(Level, Block);
+			return;
+		}
+
+		check(Level > 0);
+		for (uint32 Child = 0; Child < 4; ++Child)
+		{
+			FreeCovered(Level - 1, (Block << 2) | Child, Rect, bInside);
+		}
+	}
+
+	FIntRect FQuadtreeAllocator::GetBlockRect(int32 Level, uint32 Block) const
+	{
+		uint32 X, Y;
+		MortonDecode2D(Block, X, Y);
+
+		const FIntPoint Min(int32(X) << Level, int32(Y) << Level);
+		return FIntRect(Min, Min + FIntPoint(1 << Level, 1 << Level));
+	}
+}
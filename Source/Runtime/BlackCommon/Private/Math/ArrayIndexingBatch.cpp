@@ -0,0 +1,558 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Math/ArrayIndexingBatch.h"
+#include "Math/ArrayIndexing.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <immintrin.h>
+#if defined(__AVX2__) || (defined(PLATFORM_ALWAYS_HAS_AVX_2) && PLATFORM_ALWAYS_HAS_AVX_2)
+#define BLK_BATCH_AVX2 1
+#else
+#define BLK_BATCH_AVX2 0
+#endif
+#if defined(__SSE4_1__) || (defined(PLATFORM_ALWAYS_HAS_SSE4_1) && PLATFORM_ALWAYS_HAS_SSE4_1)
+#define BLK_BATCH_SSE4_1 1
+#else
+#define BLK_BATCH_SSE4_1 0
+#endif
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+#include <arm_neon.h>
+#endif
+
+namespace blk
+{
+	namespace
+	{
+		// One lane, also used for the tail of every batch
+		struct FScalarLanes
+		{
+			static constexpr int32 Lanes = 1;
+			uint32 V;
+
+			static FORCEINLINE FScalarLanes Load(const void* Ptr) { FScalarLanes Out; FMemory::Memcpy(&Out.V, Ptr, 4); return Out; }
+			FORCEINLINE void Store(void* Ptr) const { FMemory::Memcpy(Ptr, &V, 4); }
+			static FORCEINLINE FScalarLanes Splat(uint32 Value) { return { Value }; }
+
+			friend FORCEINLINE FScalarLanes operator+(FScalarLanes A, FScalarLanes B) { return { A.V + B.V }; }
+			friend FORCEINLINE FScalarLanes operator-(FScalarLanes A, FScalarLanes B) { return { A.V - B.V }; }
+			friend FORCEINLINE FScalarLanes operator*(FScalarLanes A, FScalarLanes B) { return { A.V * B.V }; }
+			friend FORCEINLINE FScalarLanes operator&(FScalarLanes A, FScalarLanes B) { return { A.V & B.V }; }
+			friend FORCEINLINE FScalarLanes operator|(FScalarLanes A, FScalarLanes B) { return { A.V | B.V }; }
+			friend FORCEINLINE FScalarLanes operator^(FScalarLanes A, FScalarLanes B) { return { A.V ^ B.V }; }
+
+			// ~A & B
+			static FORCEINLINE FScalarLanes AndNot(FScalarLanes A, FScalarLanes B) { return { ~A.V & B.V }; }
+			static FORCEINLINE FScalarLanes Equal(FScalarLanes A, FScalarLanes B) { return { A.V == B.V ? ~0u : 0u }; }
+			template <int32 N> FORCEINLINE FScalarLanes Shl() const { return { V << N }; }
+			template <int32 N> FORCEINLINE FScalarLanes Shr() const { return { V >> N }; }
+
+			static FORCEINLINE void DivMod(FScalarLanes N, int32 D, FScalarLanes& OutQ, FScalarLanes& OutR)
+			{
+				OutQ.V = uint32(int32(N.V) / D);
+				OutR.V = uint32(int32(N.V) % D);
+			}
+		};
+
+#if PLATFORM_CPU_X86_FAMILY && BLK_BATCH_AVX2
+		struct FVectorLanes
+		{
+			static constexpr int32 Lanes = 8;
+			__m256i V;
+
+			static FORCEINLINE FVectorLanes Load(const void* Ptr) { return { _mm256_loadu_si256(static_cast<const __m256i*>(Ptr)) }; }
+			FORCEINLINE void Store(void* Ptr) const { _mm256_storeu_si256(static_cast<__m256i*>(Ptr), V); }
+			static FORCEINLINE FVectorLanes Splat(uint32 Value) { return { _mm256_set1_epi32(int32(Value)) }; }
+
+			friend FORCEINLINE FVectorLanes operator+(FVectorLanes A, FVectorLanes B) { return { _mm256_add_epi32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator-(FVectorLanes A, FVectorLanes B) { return { _mm256_sub_epi32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator*(FVectorLanes A, FVectorLanes B) { return { _mm256_mullo_epi32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator&(FVectorLanes A, FVectorLanes B) { return { _mm256_and_si256(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator|(FVectorLanes A, FVectorLanes B) { return { _mm256_or_si256(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator^(FVectorLanes A, FVectorLanes B) { return { _mm256_xor_si256(A.V, B.V) }; }
+
+			static FORCEINLINE FVectorLanes AndNot(FVectorLanes A, FVectorLanes B) { return { _mm256_andnot_si256(A.V, B.V) }; }
+			static FORCEINLINE FVectorLanes Equal(FVectorLanes A, FVectorLanes B) { return { _mm256_cmpeq_epi32(A.V, B.V) }; }
+			template <int32 N> FORCEINLINE FVectorLanes Shl() const { return { _mm256_slli_epi32(V, N) }; }
+			template <int32 N> FORCEINLINE FVectorLanes Shr() const { return { _mm256_srli_epi32(V, N) }; }
+
+			static FORCEINLINE void DivMod(FVectorLanes N, int32 D, FVectorLanes& OutQ, FVectorLanes& OutR)
+			{
+				const __m256d Reciprocal = _mm256_set1_pd(1.0 / D);
+				const __m128i Lo = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(N.V)), Reciprocal));
+				const __m128i Hi = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(N.V, 1)), Reciprocal));
+				OutQ = { _mm256_set_m128i(Hi, Lo) };
+				OutR = N - OutQ * Splat(D);
+			}
+		};
+#elif PLATFORM_CPU_X86_FAMILY
+		struct FVectorLanes
+		{
+			static constexpr int32 Lanes = 4;
+			__m128i V;
+
+			static FORCEINLINE FVectorLanes Load(const void* Ptr) { return { _mm_loadu_si128(static_cast<const __m128i*>(Ptr)) }; }
+			FORCEINLINE void Store(void* Ptr) const { _mm_storeu_si128(static_cast<__m128i*>(Ptr), V); }
+			static FORCEINLINE FVectorLanes Splat(uint32 Value) { return { _mm_set1_epi32(int32(Value)) }; }
+
+			friend FORCEINLINE FVectorLanes operator+(FVectorLanes A, FVectorLanes B) { return { _mm_add_epi32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator-(FVectorLanes A, FVectorLanes B) { return { _mm_sub_epi32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator&(FVectorLanes A, FVectorLanes B) { return { _mm_and_si128(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator|(FVectorLanes A, FVectorLanes B) { return { _mm_or_si128(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator^(FVectorLanes A, FVectorLanes B) { return { _mm_xor_si128(A.V, B.V) }; }
+
+			friend FORCEINLINE FVectorLanes operator*(FVectorLanes A, FVectorLanes B)
+			{
+#if BLK_BATCH_SSE4_1
+				return { _mm_mullo_epi32(A.V, B.V) };
+#else
+				// SSE2 only multiplies the even lanes to 64 bits, so odd lanes go through a shift
+				const __m128i Even = _mm_mul_epu32(A.V, B.V);
+				const __m128i Odd = _mm_mul_epu32(_mm_srli_si128(A.V, 4), _mm_srli_si128(B.V, 4));
+				return { _mm_unpacklo_epi32(
+					_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)),
+					_mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0))) };
+#endif
+			}
+
+			static FORCEINLINE FVectorLanes AndNot(FVectorLanes A, FVectorLanes B) { return { _mm_andnot_si128(A.V, B.V) }; }
+			static FORCEINLINE FVectorLanes Equal(FVectorLanes A, FVectorLanes B) { return { _mm_cmpeq_epi32(A.V, B.V) }; }
+			template <int32 N> FORCEINLINE FVectorLanes Shl() const { return { _mm_slli_epi32(V, N) }; }
+			template <int32 N> FORCEINLINE FVectorLanes Shr() const { return { _mm_srli_epi32(V, N) }; }
+
+			static FORCEINLINE void DivMod(FVectorLanes N, int32 D, FVectorLanes& OutQ, FVectorLanes& OutR)
+			{
+				const __m128d Reciprocal = _mm_set1_pd(1.0 / D);
+				const __m128i Lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(N.V), Reciprocal));
+				const __m128i Hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(N.V, _MM_SHUFFLE(1, 0, 3, 2))), Reciprocal));
+				OutQ = { _mm_unpacklo_epi64(Lo, Hi) };
+				OutR = N - OutQ * Splat(D);
+			}
+		};
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+		struct FVectorLanes
+		{
+			static constexpr int32 Lanes = 4;
+			uint32x4_t V;
+
+			static FORCEINLINE FVectorLanes Load(const void* Ptr) { return { vld1q_u32(static_cast<const uint32*>(Ptr)) }; }
+			FORCEINLINE void Store(void* Ptr) const { vst1q_u32(static_cast<uint32*>(Ptr), V); }
+			static FORCEINLINE FVectorLanes Splat(uint32 Value) { return { vdupq_n_u32(Value) }; }
+
+			friend FORCEINLINE FVectorLanes operator+(FVectorLanes A, FVectorLanes B) { return { vaddq_u32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator-(FVectorLanes A, FVectorLanes B) { return { vsubq_u32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator*(FVectorLanes A, FVectorLanes B) { return { vmulq_u32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator&(FVectorLanes A, FVectorLanes B) { return { vandq_u32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator|(FVectorLanes A, FVectorLanes B) { return { vorrq_u32(A.V, B.V) }; }
+			friend FORCEINLINE FVectorLanes operator^(FVectorLanes A, FVectorLanes B) { return { veorq_u32(A.V, B.V) }; }
+
+			static FORCEINLINE FVectorLanes AndNot(FVectorLanes A, FVectorLanes B) { return { vbicq_u32(B.V, A.V) }; }
+			static FORCEINLINE FVectorLanes Equal(FVectorLanes A, FVectorLanes B) { return { vceqq_u32(A.V, B.V) }; }
+			template <int32 N> FORCEINLINE FVectorLanes Shl() const { return { vshlq_n_u32(V, N) }; }
+			template <int32 N> FORCEINLINE FVectorLanes Shr() const { return { vshrq_n_u32(V, N) }; }
+
+			static FORCEINLINE void DivMod(FVectorLanes N, int32 D, FVectorLanes& OutQ, FVectorLanes& OutR)
+			{
+				const double Reciprocal = 1.0 / D;
+				const int32x4_t Signed = vreinterpretq_s32_u32(N.V);
+				const int64x2_t Lo = vcvtq_s64_f64(vmulq_n_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(Signed))), Reciprocal));
+				const int64x2_t Hi = vcvtq_s64_f64(vmulq_n_f64(vcvtq_f64_s64(vmovl_high_s32(Signed)), Reciprocal));
+				OutQ = { vreinterpretq_u32_s32(vcombine_s32(vmovn_s64(Lo), vmovn_s64(Hi))) };
+				OutR = N - OutQ * Splat(D);
+			}
+		};
+#else
+		using FVectorLanes = FScalarLanes;
+#endif
+
+		// Runs Kernel(Lanes, i) over full vectors, then one lane at a time for the tail
+		template <typename KernelType>
+		FORCEINLINE void ForEachLanes(int32 Num, KernelType&& Kernel)
+		{
+			int32 i = 0;
+			if constexpr (FVectorLanes::Lanes > 1)
+			{
+				for (; i + FVectorLanes::Lanes <= Num; i += FVectorLanes::Lanes)
+				{
+					Kernel(FVectorLanes(), i);
+				}
+			}
+			for (; i < Num; ++i)
+			{
+				Kernel(FScalarLanes(), i);
+			}
+		}
+
+		// The reciprocal quotient can be one off near multiples of D, this settles it exactly
+		template <typename TLanes>
+		FORCEINLINE void DivModExact(TLanes N, int32 D, TLanes& OutQ, TLanes& OutR)
+		{
+			TLanes::DivMod(N, D, OutQ, OutR);
+			if constexpr (TLanes::Lanes > 1)
+			{
+				// Sign bit set means the remainder went negative
+				const TLanes Under = TLanes::Equal(OutR.template Shr<31>(), TLanes::Splat(1));
+				OutQ = OutQ + Under;
+				OutR = OutR + (Under & TLanes::Splat(D));
+
+				// Over once R - D is non negative
+				const TLanes Over = TLanes::Equal((OutR - TLanes::Splat(D)).template Shr<31>(), TLanes::Splat(0));
+				OutQ = OutQ - Over;
+				OutR = OutR - (Over & TLanes::Splat(D));
+			}
+		}
+
+		template <typename TLanes>
+		FORCEINLINE TLanes Spread2D(TLanes V)
+		{
+			V = V & TLanes::Splat(0x0000FFFF);
+			V = (V | V.template Shl<8>()) & TLanes::Splat(0x00FF00FF);
+			V = (V | V.template Shl<4>()) & TLanes::Splat(0x0F0F0F0F);
+			V = (V | V.template Shl<2>()) & TLanes::Splat(0x33333333);
+			V = (V | V.template Shl<1>()) & TLanes::Splat(0x55555555);
+			return V;
+		}
+
+		template <typename TLanes>
+		FORCEINLINE TLanes Compact2D(TLanes V)
+		{
+			V = V & TLanes::Splat(0x55555555);
+			V = (V | V.template Shr<1>()) & TLanes::Splat(0x33333333);
+			V = (V | V.template Shr<2>()) & TLanes::Splat(0x0F0F0F0F);
+			V = (V | V.template Shr<4>()) & TLanes::Splat(0x00FF00FF);
+			V = (V | V.template Shr<8>()) & TLanes::Splat(0x0000FFFF);
+			return V;
+		}
+
+		template <typename TLanes>
+		FORCEINLINE TLanes Spread3D(TLanes V)
+		{
+			V = V & TLanes::Splat(0x000003FF);
+			V = (V | V.template Shl<16>()) & TLanes::Splat(0xFF0000FF);
+			V = (V | V.template Shl<8>()) & TLanes::Splat(0x0300F00F);
+			V = (V | V.template Shl<4>()) & TLanes::Splat(0x030C30C3);
+			V = (V | V.template Shl<2>()) & TLanes::Splat(0x09249249);
+			return V;
+		}
+
+		template <typename TLanes>
+		FORCEINLINE TLanes Compact3D(TLanes V)
+		{
+			V = V & TLanes::Splat(0x09249249);
+			V = (V | V.template Shr<2>()) & TLanes::Splat(0x030C30C3);
+			V = (V | V.template Shr<4>()) & TLanes::Splat(0x0300F00F);
+			V = (V | V.template Shr<8>()) & TLanes::Splat(0xFF0000FF);
+			V = (V | V.template Shr<16>()) & TLanes::Splat(0x000003FF);
+			return V;
+		}
+
+		// All ones where (V & Bit) is set
+		template <typename TLanes>
+		FORCEINLINE TLanes HasBit(TLanes V, uint32 Bit)
+		{
+			return TLanes::Equal(V & TLanes::Splat(Bit), TLanes::Splat(Bit));
+		}
+
+		// The Hilbert loops of ArrayIndexing with every branch turned into a lane mask
+		template <typename TLanes>
+		FORCEINLINE TLanes HilbertEncode2DLanes(TLanes X, TLanes Y, int32 Order)
+		{
+			TLanes Index = TLanes::Splat(0);
+			for (uint32 S = (1u << Order) >> 1; S > 0; S >>= 1)
+			{
+				const TLanes RX = HasBit(X, S);
+				const TLanes RY = HasBit(Y, S);
+				const TLanes Quadrant = (RX & TLanes::Splat(3)) ^ (RY & TLanes::Splat(1));
+				Index = Index + Quadrant * TLanes::Splat(S * S);
+
+				const TLanes Flip = TLanes::AndNot(RY, RX) & TLanes::Splat(S - 1);
+				X = X ^ Flip;
+				Y = Y ^ Flip;
+
+				const TLanes Swap = TLanes::AndNot(RY, X ^ Y);
+				X = X ^ Swap;
+				Y = Y ^ Swap;
+			}
+			return Index;
+		}
+
+		template <typename TLanes>
+		FORCEINLINE void HilbertDecode2DLanes(TLanes Index, int32 Order, TLanes& OutX, TLanes& OutY)
+		{
+			TLanes X = TLanes::Splat(0);
+			TLanes Y = TLanes::Splat(0);
+			for (uint32 S = 1; S < (1u << Order); S <<= 1)
+			{
+				const TLanes RX = HasBit(Index, 2);
+				const TLanes RY = TLanes::Equal((Index ^ Index.template Shr<1>()) & TLanes::Splat(1), TLanes::Splat(1));
+
+				const TLanes Flip = TLanes::AndNot(RY, RX) & TLanes::Splat(S - 1);
+				X = X ^ Flip;
+				Y = Y ^ Flip;
+
+				const TLanes Swap = TLanes::AndNot(RY, X ^ Y);
+				X = X ^ Swap;
+				Y = Y ^ Swap;
+
+				X = X + (RX & TLanes::Splat(S));
+				Y = Y + (RY & TLanes::Splat(S));
+				Index = Index.template Shr<2>();
+			}
+			OutX = X;
+			OutY = Y;
+		}
+
+		template <typename TLanes>
+		FORCEINLINE TLanes HilbertEncode3DLanes(TLanes X, TLanes Y, TLanes Z, int32 Order)
+		{
+			TLanes Axes[3] = { X, Y, Z };
+
+			for (uint32 Q = (1u << Order) >> 1; Q > 1; Q >>= 1)
+			{
+				const TLanes P = TLanes::Splat(Q - 1);
+				for (int32 i = 0; i < 3; ++i)
+				{
+					const TLanes Set = HasBit(Axes[i], Q);
+					Axes[0] = Axes[0] ^ (Set & P);
+					const TLanes T = TLanes::AndNot(Set, (Axes[0] ^ Axes[i]) & P);
+					Axes[0] = Axes[0] ^ T;
+					Axes[i] = Axes[i] ^ T;
+				}
+			}
+
+			Axes[1] = Axes[1] ^ Axes[0];
+			Axes[2] = Axes[2] ^ Axes[1];
+			TLanes T = TLanes::Splat(0);
+			for (uint32 Q = (1u << Order) >> 1; Q > 1; Q >>= 1)
+			{
+				T = T ^ (HasBit(Axes[2], Q) & TLanes::Splat(Q - 1));
+			}
+			Axes[0] = Axes[0] ^ T;
+			Axes[1] = Axes[1] ^ T;
+			Axes[2] = Axes[2] ^ T;
+
+			return Spread3D(Axes[0]).template Shl<2>() | Spread3D(Axes[1]).template Shl<1>() | Spread3D(Axes[2]);
+		}
+
+		template <typename TLanes>
+		FORCEINLINE void HilbertDecode3DLanes(TLanes Index, int32 Order, TLanes& OutX, TLanes& OutY, TLanes& OutZ)
+		{
+			TLanes Axes[3] = { Compact3D(Index.template Shr<2>()), Compact3D(Index.template Shr<1>()), Compact3D(Index) };
+
+			const TLanes T = Axes[2].template Shr<1>();
+			Axes[2] = Axes[2] ^ Axes[1];
+			Axes[1] = Axes[1] ^ Axes[0];
+			Axes[0] = Axes[0] ^ T;
+
+			for (uint32 Q = 2; Q < (1u << Order); Q <<= 1)
+			{
+				const TLanes P = TLanes::Splat(Q - 1);
+				for (int32 i = 2; i >= 0; --i)
+				{
+					const TLanes Set = HasBit(Axes[i], Q);
+					Axes[0] = Axes[0] ^ (Set & P);
+					const TLanes Swap = TLanes::AndNot(Set, (Axes[0] ^ Axes[i]) & P);
+					Axes[0] = Axes[0] ^ Swap;
+					Axes[i] = Axes[i] ^ Swap;
+				}
+			}
+
+			OutX = Axes[0];
+			OutY = Axes[1];
+			OutZ = Axes[2];
+		}
+	}
+
+	void Index2DTo1DBatch(
+		TArrayView<const int32> X, TArrayView<const int32> Y,
+		int32 Width,
+		TArrayView<int32> OutIndex)
+	{
+		check(X.Num() == Y.Num() && X.Num() == OutIndex.Num());
+
+		ForEachLanes(X.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			(TLanes::Load(&Y[i]) * TLanes::Splat(Width) + TLanes::Load(&X[i])).Store(&OutIndex[i]);
+		});
+	}
+
+	void Index3DTo1DBatch(
+		TArrayView<const int32> X, TArrayView<const int32> Y, TArrayView<const int32> Z,
+		int32 Width, int32 Height,
+		TArrayView<int32> OutIndex)
+	{
+		check(X.Num() == Y.Num() && X.Num() == Z.Num() && X.Num() == OutIndex.Num());
+
+		ForEachLanes(X.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			const TLanes Plane = TLanes::Load(&Z[i]) * TLanes::Splat(Width * Height);
+			(Plane + TLanes::Load(&Y[i]) * TLanes::Splat(Width) + TLanes::Load(&X[i])).Store(&OutIndex[i]);
+		});
+	}
+
+	void Index1DTo2DBatch(
+		TArrayView<const int32> Index,
+		int32 Width,
+		TArrayView<int32> OutX, TArrayView<int32> OutY)
+	{
+		check(Index.Num() == OutX.Num() && Index.Num() == OutY.Num());
+		check(Width > 0);
+
+		ForEachLanes(Index.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			TLanes Y, X;
+			DivModExact(TLanes::Load(&Index[i]), Width, Y, X);
+			X.Store(&OutX[i]);
+			Y.Store(&OutY[i]);
+		});
+	}
+
+	void Index1DTo3DBatch(
+		TArrayView<const int32> Index,
+		int32 Width, int32 Height,
+		TArrayView<int32> OutX, TArrayView<int32> OutY, TArrayView<int32> OutZ)
+	{
+		check(Index.Num() == OutX.Num() && Index.Num() == OutY.Num() && Index.Num() == OutZ.Num());
+		check(Width > 0 && Height > 0);
+
+		ForEachLanes(Index.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			TLanes Z, Remainder, Y, X;
+			DivModExact(TLanes::Load(&Index[i]), Width * Height, Z, Remainder);
+			DivModExact(Remainder, Width, Y, X);
+			X.Store(&OutX[i]);
+			Y.Store(&OutY[i]);
+			Z.Store(&OutZ[i]);
+		});
+	}
+
+	void MortonEncode2DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y,
+		TArrayView<uint32> OutCode)
+	{
+		check(X.Num() == Y.Num() && X.Num() == OutCode.Num());
+
+		ForEachLanes(X.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			(Spread2D(TLanes::Load(&X[i])) | Spread2D(TLanes::Load(&Y[i])).template Shl<1>()).Store(&OutCode[i]);
+		});
+	}
+
+	void MortonDecode2DBatch(
+		TArrayView<const uint32> Code,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY)
+	{
+		check(Code.Num() == OutX.Num() && Code.Num() == OutY.Num());
+
+		ForEachLanes(Code.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			const TLanes Value = TLanes::Load(&Code[i]);
+			Compact2D(Value).Store(&OutX[i]);
+			Compact2D(Value.template Shr<1>()).Store(&OutY[i]);
+		});
+	}
+
+	void MortonEncode3DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y, TArrayView<const uint32> Z,
+		TArrayView<uint32> OutCode)
+	{
+		check(X.Num() == Y.Num() && X.Num() == Z.Num() && X.Num() == OutCode.Num());
+
+		ForEachLanes(X.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			const TLanes Code = Spread3D(TLanes::Load(&X[i]))
+				| Spread3D(TLanes::Load(&Y[i])).template Shl<1>()
+				| Spread3D(TLanes::Load(&Z[i])).template Shl<2>();
+			Code.Store(&OutCode[i]);
+		});
+	}
+
+	void MortonDecode3DBatch(
+		TArrayView<const uint32> Code,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY, TArrayView<uint32> OutZ)
+	{
+		check(Code.Num() == OutX.Num() && Code.Num() == OutY.Num() && Code.Num() == OutZ.Num());
+
+		ForEachLanes(Code.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			const TLanes Value = TLanes::Load(&Code[i]);
+			Compact3D(Value).Store(&OutX[i]);
+			Compact3D(Value.template Shr<1>()).Store(&OutY[i]);
+			Compact3D(Value.template Shr<2>()).Store(&OutZ[i]);
+		});
+	}
+
+	void HilbertEncode2DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y,
+		int32 Order,
+		TArrayView<uint32> OutIndex)
+	{
+		check(X.Num() == Y.Num() && X.Num() == OutIndex.Num());
+		check(Order >= 0 && Order <= 16);
+
+		ForEachLanes(X.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			HilbertEncode2DLanes(TLanes::Load(&X[i]), TLanes::Load(&Y[i]), Order).Store(&OutIndex[i]);
+		});
+	}
+
+	void HilbertDecode2DBatch(
+		TArrayView<const uint32> Index,
+		int32 Order,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY)
+	{
+		check(Index.Num() == OutX.Num() && Index.Num() == OutY.Num());
+		check(Order >= 0 && Order <= 16);
+
+		ForEachLanes(Index.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			TLanes X, Y;
+			HilbertDecode2DLanes(TLanes::Load(&Index[i]), Order, X, Y);
+			X.Store(&OutX[i]);
+			Y.Store(&OutY[i]);
+		});
+	}
+
+	void HilbertEncode3DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y, TArrayView<const uint32> Z,
+		int32 Order,
+		TArrayView<uint32> OutIndex)
+	{
+		check(X.Num() == Y.Num() && X.Num() == Z.Num() && X.Num() == OutIndex.Num());
+		check(Order >= 0 && Order <= 10);
+
+		ForEachLanes(X.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			HilbertEncode3DLanes(TLanes::Load(&X[i]), TLanes::Load(&Y[i]), TLanes::Load(&Z[i]), Order).Store(&OutIndex[i]);
+		});
+	}
+
+	void HilbertDecode3DBatch(
+		TArrayView<const uint32> Index,
+		int32 Order,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY, TArrayView<uint32> OutZ)
+	{
+		check(Index.Num() == OutX.Num() && Index.Num() == OutY.Num() && Index.Num() == OutZ.Num());
+		check(Order >= 0 && Order <= 10);
+
+		ForEachLanes(Index.Num(), [&](auto Lanes, int32 i)
+		{
+			using TLanes = decltype(Lanes);
+			TLanes X, Y, Z;
+			HilbertDecode3DLanes(TLanes::Load(&Index[i]), Order, X, Y, Z);
+			X.Store(&OutX[i]);
+			Y.Store(&OutY[i]);
+			Z.Store(&OutZ[i]);
+		});
+	}
+}
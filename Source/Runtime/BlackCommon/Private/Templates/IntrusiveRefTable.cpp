@@ -0,0 +1,3 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Templates/IntrusiveRefTable.h"
\ No newline at end of file
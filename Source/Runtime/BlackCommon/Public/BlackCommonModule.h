@@ -9,4 +9,7 @@ class FBlackCommonModule : public IModuleInterface
 public:
     virtual void StartupModule() override;
     virtual void ShutdownModule() override;
+
+private:
+    FDelegateHandle EndFrameHandle;
 };
\ No newline at end of file
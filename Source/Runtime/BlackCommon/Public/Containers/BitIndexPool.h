@@ -0,0 +1,155 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace blk
+{
+	// Index pool that always hands out the lowest free index, so live indices stay packed at
+	// the bottom of the range. One bit per index, plus a summary bit per 64 bit word that is set
+	// once the word is full, so finding a free index skips 4096 indices per summary word.
+	template <typename TIndex = int32>
+	class TBitIndexPool
+	{
+	public:
+		TBitIndexPool()
+		{
+			Clear();
+		}
+
+		TIndex Acquire()
+		{
+			const int32 Word = FindFreeWord();
+			const int32 Bit = int32(FMath::CountTrailingZeros64(~Used[Word]));
+			SetBit(Word, Bit);
+			return TIndex(Word * 64 + Bit);
+		}
+
+		// Appends Count indices to OutIndices, lowest first
+		void AcquireN(int32 Count, TArray<TIndex>& OutIndices)
+		{
+			OutIndices.Reserve(OutIndices.Num() + Count);
+
+			while (Count > 0)
+			{
+				const int32 Word = FindFreeWord();
+
+				// Takes every free bit of the word before looking for the next one
+				uint64 Free = ~Used[Word];
+				while (Free != 0 && Count > 0)
+				{
+					const int32 Bit = int32(FMath::CountTrailingZeros64(Free));
+					Free &= Free - 1;
+
+					SetBit(Word, Bit);
+					OutIndices.Add(TIndex(Word * 64 + Bit));
+					--Count;
+				}
+			}
+		}
+
+		void Release(TIndex Index)
+		{
+			check(IsAcquired(Index));
+
+			const int32 Word = int32(Index) / 64;
+			Used[Word] &= ~(uint64(1) << (int32(Index) % 64));
+			Full[Word / 64] &= ~(uint64(1) << (Word % 64));
+			--Num;
+		}
+
+		void ReleaseN(TArrayView<const TIndex> Indices)
+		{
+			for (TIndex Index : Indices)
+			{
+				Release(Index);
+			}
+		}
+
+		bool IsAcquired(TIndex Index) const
+		{
+			const int32 Word = int32(Index) / 64;
+			return Index >= 0 && Word < Used.Num() && (Used[Word] >> (int32(Index) % 64)) & 1;
+		}
+
+		// Number of acquired indices
+		FORCEINLINE int32 GetNum() const { return Num; }
+
+		// One past the highest acquired index. Storage indexed by the pool can be trimmed to it.
+		TIndex GetHighWaterMark() const
+		{
+			for (int32 Word = Used.Num() - 1; Word >= 0; --Word)
+			{
+				if (Used[Word] != 0)
+				{
+					return TIndex(Word * 64 + 64 - int32(FMath::CountLeadingZeros64(Used[Word])));
+				}
+			}
+			return TIndex(0);
+		}
+
+		// Calls Func(Index) for every acquired index in ascending order
+		template <typename FuncType>
+		void ForEachAcquired(FuncType&& Func) const
+		{
+			for (int32 Word = 0; Word < Used.Num(); ++Word)
+			{
+				uint64 Bits = Used[Word];
+				while (Bits != 0)
+				{
+					const int32 Bit = int32(FMath::CountTrailingZeros64(Bits));
+					Bits &= Bits - 1;
+					Func(TIndex(Word * 64 + Bit));
+				}
+			}
+		}
+
+		// Frees the bitmap words above the high water mark
+		void Trim()
+		{
+			int32 WordCount = Used.Num();
+			while (WordCount > 0 && Used[WordCount - 1] == 0) --WordCount;
+
+			Used.SetNum(WordCount);
+			Full.SetNum(FMath::DivideAndRoundUp(WordCount, 64));
+		}
+
+		// Reset the pool to start fresh
+		void Clear()
+		{
+			Used.Reset();
+			Full.Reset();
+			Num = 0;
+		}
+
+	private:
+		// Lowest word with a free bit, appending one if every word is full
+		int32 FindFreeWord()
+		{
+			for (int32 Summary = 0; Summary < Full.Num(); ++Summary)
+			{
+				if (Full[Summary] == ~uint64(0)) continue;
+
+				const int32 Word = Summary * 64 + int32(FMath::CountTrailingZeros64(~Full[Summary]));
+				if (Word < Used.Num()) return Word;
+				break;
+			}
+
+			const int32 Word = Used.Add(0);
+			if (Word / 64 == Full.Num()) Full.Add(0);
+			return Word;
+		}
+
+		FORCEINLINE void SetBit(int32 Word, int32 Bit)
+		{
+			Used[Word] |= uint64(1) << Bit;
+			if (Used[Word] == ~uint64(0)) Full[Word / 64] |= uint64(1) << (Word % 64);
+			++Num;
+		}
+
+		TArray<uint64> Used; // One bit per index, set while acquired
+		TArray<uint64> Full; // One bit per Used word, set while the word is full
+		int32 Num = 0;
+	};
+}
@@ -0,0 +1,238 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include <atomic>
+
+namespace blk
+{
+	// Thread safe variant of TIndexPool over a fixed range of indices.
+	// Released indices go on a lock-free list whose head carries a tag against ABA, fresh
+	// indices come from an atomic bump, and each thread first tries a small magazine of its own.
+	template <typename TIndex = int32, int32 MagazineSize = 16>
+	class TConcurrentIndexPool
+	{
+		static_assert(sizeof(TIndex) <= sizeof(uint32), "Indices are packed with a 32 bit tag");
+		static_assert(MagazineSize >= 2, "Magazines hand back half of their indices at a time");
+
+	public:
+		static constexpr TIndex None = TIndex(-1);
+
+		explicit TConcurrentIndexPool(TIndex InCapacity = 0)
+		{
+			Init(InCapacity);
+		}
+
+		TConcurrentIndexPool(const TConcurrentIndexPool&) = delete;
+		TConcurrentIndexPool& operator=(const TConcurrentIndexPool&) = delete;
+
+		// Sizes the pool for [0, InCapacity). Not thread safe.
+		void Init(TIndex InCapacity)
+		{
+			Capacity = InCapacity;
+			Links = MakeUnique<std::atomic<TIndex>[]>(FMath::Max<int32>(Capacity, 1));
+
+			const int32 SlotCount = FMath::Clamp(
+				int32(FMath::RoundUpToPowerOfTwo(FPlatformMisc::NumberOfCoresIncludingHyperthreads())), 1, 64);
+			Slots = MakeUnique<FSlot[]>(SlotCount);
+			SlotShift = 32 - FMath::FloorLog2(SlotCount);
+
+			Clear();
+		}
+
+		// Releases every index at once. Not thread safe.
+		void Clear()
+		{
+			Next.store(0, std::memory_order_relaxed);
+			Head.store(Pack(None, 0), std::memory_order_relaxed);
+
+			const int32 SlotCount = 1 << (32 - SlotShift);
+			for (int32 i = 0; i < SlotCount; ++i)
+			{
+				Slots[i].Count = 0;
+			}
+		}
+
+		// Returns None once every index is in use. Indices cached in a magazine still count as
+		// free, a contended magazine is waited on before giving up.
+		TIndex Acquire()
+		{
+			TIndex Result = None;
+
+			FSlot& Slot = GetSlot();
+			if (Slot.TryLock())
+			{
+				if (Slot.Count == 0) Slot.Count = Refill(Slot.Items, MagazineSize / 2);
+				if (Slot.Count > 0) Result = Slot.Items[--Slot.Count];
+				Slot.Unlock();
+			}
+			else
+			{
+				// Another thread hashed to the same magazine, skip it rather than wait
+				Refill(&Result, 1);
+			}
+
+			return Result != None ? Result : Steal();
+		}
+
+		void Release(TIndex Index)
+		{
+			check(Index >= 0 && Index < Capacity);
+
+			FSlot& Slot = GetSlot();
+			if (!Slot.TryLock())
+			{
+				PushFree(&Index, 1);
+				return;
+			}
+
+			// A full magazine hands its older half back to the shared list in one push
+			if (Slot.Count == MagazineSize)
+			{
+				constexpr int32 Half = MagazineSize / 2;
+				PushFree(Slot.Items, Half);
+				FMemory::Memmove(Slot.Items, Slot.Items + Half, (MagazineSize - Half) * sizeof(TIndex));
+				Slot.Count -= Half;
+			}
+
+			Slot.Items[Slot.Count++] = Index;
+			Slot.Unlock();
+		}
+
+		FORCEINLINE TIndex GetCapacity() const { return Capacity; }
+
+		// Indices handed out by the bump so far. Nothing at or above it has ever been acquired.
+		FORCEINLINE TIndex GetHighWaterMark() const { return Next.load(std::memory_order_relaxed); }
+
+	private:
+		struct alignas(PLATFORM_CACHE_LINE_SIZE) FSlot
+		{
+			std::atomic<bool> bBusy{ false };
+			int32 Count = 0;
+			TIndex Items[MagazineSize];
+
+			FORCEINLINE bool TryLock() { return !bBusy.exchange(true, std::memory_order_acquire); }
+			FORCEINLINE void Unlock() { bBusy.store(false, std::memory_order_release); }
+		};
+
+		static FORCEINLINE uint64 Pack(TIndex Index, uint32 Tag)
+		{
+			return (uint64(Tag) << 32) | uint32(Index);
+		}
+
+		static FORCEINLINE TIndex UnpackIndex(uint64 Word) { return TIndex(uint32(Word)); }
+		static FORCEINLINE uint32 UnpackTag(uint64 Word) { return uint32(Word >> 32); }
+
+		// Thread ids are often aligned, so they are spread with a Fibonacci hash
+		FORCEINLINE FSlot& GetSlot()
+		{
+			const uint32 Hash = FPlatformTLS::GetCurrentThreadId() * 0x9E3779B9u;
+			return Slots[SlotShift < 32 ? Hash >> SlotShift : 0];
+		}
+
+		// Free list first, then fresh indices
+		int32 Refill(TIndex* Out, int32 Max)
+		{
+			const int32 Count = PopFree(Out, Max);
+			return Count > 0 ? Count : Bump(Out, Max);
+		}
+
+		// Links the indices into a chain and publishes it with a single CAS
+		void PushFree(const TIndex* Items, int32 Count)
+		{
+			for (int32 i = 0; i + 1 < Count; ++i)
+			{
+				Links[Items[i]].store(Items[i + 1], std::memory_order_relaxed);
+			}
+
+			std::atomic<TIndex>& Last = Links[Items[Count - 1]];
+			uint64 Current = Head.load(std::memory_order_relaxed);
+			do
+			{
+				Last.store(UnpackIndex(Current), std::memory_order_relaxed);
+			}
+			while (!Head.compare_exchange_weak(
+				Current, Pack(Items[0], UnpackTag(Current) + 1),
+				std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		// Walks up to Max links and cuts them off with a single CAS. Links read while racing can
+		// be stale, but any change to the list bumps the tag, so such a walk never commits.
+		int32 PopFree(TIndex* Out, int32 Max)
+		{
+			uint64 Current = Head.load(std::memory_order_acquire);
+			for (;;)
+			{
+				TIndex Index = UnpackIndex(Current);
+				int32 Count = 0;
+				while (Count < Max && Index != None)
+				{
+					Out[Count++] = Index;
+					Index = Links[Index].load(std::memory_order_relaxed);
+				}
+
+				if (Count == 0) return 0;
+
+				if (Head.compare_exchange_weak(
+					Current, Pack(Index, UnpackTag(Current) + 1),
+					std::memory_order_acquire, std::memory_order_acquire))
+				{
+					return Count;
+				}
+			}
+		}
+
+		int32 Bump(TIndex* Out, int32 Max)
+		{
+			TIndex Start = Next.load(std::memory_order_relaxed);
+			int32 Count;
+			do
+			{
+				Count = FMath::Min<int32>(Max, Capacity - Start);
+				if (Count <= 0) return 0;
+			}
+			while (!Next.compare_exchange_weak(Start, TIndex(Start + Count), std::memory_order_relaxed));
+
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Out[i] = TIndex(Start + i);
+			}
+			return Count;
+		}
+
+		// Last resort once the shared list and the bump are empty. Magazines are only held for a
+		// few instructions and never while taking another, so busy ones are waited on instead of
+		// skipped, which would report None with indices still cached.
+		TIndex Steal()
+		{
+			const int32 SlotCount = 1 << (32 - SlotShift);
+			for (int32 i = 0; i < SlotCount; ++i)
+			{
+				FSlot& Slot = Slots[i];
+				while (!Slot.TryLock())
+				{
+					FPlatformProcess::YieldThread();
+				}
+
+				const TIndex Result = Slot.Count > 0 ? Slot.Items[--Slot.Count] : None;
+				Slot.Unlock();
+				if (Result != None) return Result;
+			}
+
+			TIndex Result = None;
+			PopFree(&Result, 1);
+			return Result;
+		}
+
+		TIndex Capacity = 0;
+		uint32 SlotShift = 32;
+
+		TUniquePtr<std::atomic<TIndex>[]> Links;
+		TUniquePtr<FSlot[]> Slots;
+
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head{ 0 };
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<TIndex> Next{ 0 };
+	};
+}
@@ -0,0 +1,171 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LockFreeList.h"
+#include "Templates/PooledPtr.h"
+#include <atomic>
+
+namespace blk
+{
+	template <typename T>
+	struct TDefaultObjectPoolFactory
+	{
+		FORCEINLINE T* operator()() const { return new T(); }
+	};
+
+	// Thread safe variant of TObjectPool. Objects are handed out by pointer, so they never move,
+	// and are created by a factory type known at compile time. Each thread first tries a small
+	// cache of its own, full caches spill half of their objects into a shared lock-free depot.
+	// At most MaxPooled idle objects are kept, anything released beyond that is deleted.
+	//
+	// TFactory is default constructed and called as T*(), objects are freed with delete.
+	template <typename T, typename TFactory = TDefaultObjectPoolFactory<T>, int32 CacheSize = 8>
+	class TConcurrentObjectPool
+	{
+		static_assert(CacheSize >= 2, "Caches hand back half of their objects at a time");
+
+	public:
+		using FPooledPtr = TPooledPtr<T, TConcurrentObjectPool>;
+
+		explicit TConcurrentObjectPool(int32 InMaxPooled = MAX_int32)
+			: MaxPooled(InMaxPooled)
+		{
+			const int32 CacheCount = FMath::Clamp(
+				int32(FMath::RoundUpToPowerOfTwo(FPlatformMisc::NumberOfCoresIncludingHyperthreads())), 1, 64);
+			Caches = MakeUnique<FCache[]>(CacheCount);
+			CacheShift = 32 - FMath::FloorLog2(CacheCount);
+		}
+
+		~TConcurrentObjectPool()
+		{
+			Trim(0);
+		}
+
+		TConcurrentObjectPool(const TConcurrentObjectPool&) = delete;
+		TConcurrentObjectPool& operator=(const TConcurrentObjectPool&) = delete;
+
+		// An idle object if there is one, a new one from the factory otherwise
+		T* Acquire()
+		{
+			T* Result = nullptr;
+
+			FCache& Cache = GetCache();
+			if (Cache.TryLock())
+			{
+				if (Cache.Count > 0) Result = Cache.Items[--Cache.Count];
+				Cache.Unlock();
+			}
+
+			if (!Result) Result = Depot.Pop();
+			if (!Result) return TFactory()();
+
+			PooledCount.fetch_sub(1, std::memory_order_relaxed);
+			return Result;
+		}
+
+		// Acquire behind a handle that releases the object when it dies
+		FORCEINLINE FPooledPtr AcquirePtr()
+		{
+			return FPooledPtr(Acquire(), *this);
+		}
+
+		void Release(T* Object)
+		{
+			check(Object);
+
+			if (PooledCount.fetch_add(1, std::memory_order_relaxed) >= MaxPooled.load(std::memory_order_relaxed))
+			{
+				PooledCount.fetch_sub(1, std::memory_order_relaxed);
+				delete Object;
+				return;
+			}
+
+			FCache& Cache = GetCache();
+			if (!Cache.TryLock())
+			{
+				Depot.Push(Object);
+				return;
+			}
+
+			// A full cache hands its older half to the depot
+			if (Cache.Count == CacheSize)
+			{
+				constexpr int32 Half = CacheSize / 2;
+				for (int32 i = 0; i < Half; ++i)
+				{
+					Depot.Push(Cache.Items[i]);
+				}
+				FMemory::Memmove(Cache.Items, Cache.Items + Half, (CacheSize - Half) * sizeof(T*));
+				Cache.Count -= Half;
+			}
+
+			Cache.Items[Cache.Count++] = Object;
+			Cache.Unlock();
+		}
+
+		// Deletes idle objects until at most Target are left and returns how many went. Caches
+		// are emptied into the depot first, those busy on other threads are skipped.
+		int32 Trim(int32 Target = 0)
+		{
+			const int32 CacheCount = 1 << (32 - CacheShift);
+			for (int32 i = 0; i < CacheCount; ++i)
+			{
+				FCache& Cache = Caches[i];
+				if (!Cache.TryLock()) continue;
+
+				for (int32 Item = 0; Item < Cache.Count; ++Item)
+				{
+					Depot.Push(Cache.Items[Item]);
+				}
+				Cache.Count = 0;
+				Cache.Unlock();
+			}
+
+			int32 Freed = 0;
+			while (PooledCount.load(std::memory_order_relaxed) > Target)
+			{
+				T* Object = Depot.Pop();
+				if (!Object) break;
+
+				PooledCount.fetch_sub(1, std::memory_order_relaxed);
+				delete Object;
+				++Freed;
+			}
+			return Freed;
+		}
+
+		// Idle objects, approximate while other threads acquire or release
+		FORCEINLINE int32 GetPooledCount() const { return PooledCount.load(std::memory_order_relaxed); }
+
+		FORCEINLINE int32 GetMaxPooled() const { return MaxPooled.load(std::memory_order_relaxed); }
+
+		// Takes effect on the next Release, call Trim to drop objects above the new limit
+		FORCEINLINE void SetMaxPooled(int32 InMaxPooled) { MaxPooled.store(InMaxPooled, std::memory_order_relaxed); }
+
+	private:
+		struct alignas(PLATFORM_CACHE_LINE_SIZE) FCache
+		{
+			std::atomic<bool> bBusy{ false };
+			int32 Count = 0;
+			T* Items[CacheSize];
+
+			FORCEINLINE bool TryLock() { return !bBusy.exchange(true, std::memory_order_acquire); }
+			FORCEINLINE void Unlock() { bBusy.store(false, std::memory_order_release); }
+		};
+
+		// Thread ids are often aligned, so they are spread with a Fibonacci hash
+		FORCEINLINE FCache& GetCache()
+		{
+			const uint32 Hash = FPlatformTLS::GetCurrentThreadId() * 0x9E3779B9u;
+			return Caches[CacheShift < 32 ? Hash >> CacheShift : 0];
+		}
+
+		std::atomic<int32> MaxPooled; // Read by every Release, may be changed while they run
+		uint32 CacheShift = 32;
+		TUniquePtr<FCache[]> Caches;
+		TLockFreePointerListUnordered<T, PLATFORM_CACHE_LINE_SIZE> Depot;
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<int32> PooledCount{ 0 };
+	};
+}
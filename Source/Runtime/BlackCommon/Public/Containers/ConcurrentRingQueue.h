@@ -0,0 +1,213 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace blk
+{
+	// Bounded lock-free FIFO for any number of producers and consumers. Every cell carries a
+	// sequence number that tells whose turn it is on the current lap, so producers and consumers
+	// only contend on their own cursor, and the two cursors sit on separate cache lines.
+	//
+	// Push and TryPop follow TStack's naming, so the queue can back TIndexPool or TObjectPool
+	// when FIFO reuse is wanted. Reserve and Clear are not thread safe.
+	template <typename T>
+	class TConcurrentRingQueue
+	{
+	public:
+		static constexpr bool bIsConcurrent = true;
+
+		explicit TConcurrentRingQueue(int32 InCapacity = 0)
+		{
+			Reserve(InCapacity);
+		}
+
+		TConcurrentRingQueue(const TConcurrentRingQueue&) = delete;
+		TConcurrentRingQueue& operator=(const TConcurrentRingQueue&) = delete;
+
+		// Sizes the ring for at least InCapacity elements, rounded up to a power of two, and
+		// empties it
+		void Reserve(int32 InCapacity)
+		{
+			check(InCapacity >= 0);
+
+			const uint32 CellCount = FMath::RoundUpToPowerOfTwo(uint32(FMath::Max(InCapacity, 2)));
+			Mask = CellCount - 1;
+			Cells = MakeUnique<FCell[]>(CellCount);
+			Clear();
+		}
+
+		void Clear()
+		{
+			for (uint32 i = 0; i <= Mask; ++i)
+			{
+				Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+
+			EnqueuePos.store(0, std::memory_order_relaxed);
+			DequeuePos.store(0, std::memory_order_relaxed);
+		}
+
+		// Returns false when the ring is full
+		template <typename U>
+		bool Push(U&& Item)
+		{
+			uint32 Pos;
+			if (ClaimEnqueue(1, Pos) == 0) return false;
+
+			FCell& Cell = Cells[Pos & Mask];
+			Cell.Value = Forward<U>(Item);
+			Cell.Sequence.store(Pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Returns false when the ring is empty
+		bool TryPop(T& OutItem)
+		{
+			uint32 Pos;
+			if (ClaimDequeue(1, Pos) == 0) return false;
+
+			FCell& Cell = Cells[Pos & Mask];
+			OutItem = MoveTemp(Cell.Value);
+			Cell.Sequence.store(Pos + Mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Pushes as many elements of the view as there are free cells, claiming each run of
+		// cells with a single CAS. Returns how many were pushed.
+		int32 PushN(TArrayView<const T> NewItems)
+		{
+			int32 Pushed = 0;
+			while (Pushed < NewItems.Num())
+			{
+				uint32 Pos;
+				const int32 Claimed = ClaimEnqueue(NewItems.Num() - Pushed, Pos);
+				if (Claimed == 0) break;
+
+				for (int32 i = 0; i < Claimed; ++i)
+				{
+					FCell& Cell = Cells[(Pos + i) & Mask];
+					Cell.Value = NewItems[Pushed + i];
+					Cell.Sequence.store(Pos + i + 1, std::memory_order_release);
+				}
+				Pushed += Claimed;
+			}
+			return Pushed;
+		}
+
+		// Pops up to MaxCount elements onto the end of Out, oldest first. Returns how many were
+		// popped.
+		template <typename OutAllocator>
+		int32 PopN(int32 MaxCount, TArray<T, OutAllocator>& Out)
+		{
+			int32 Popped = 0;
+			while (Popped < MaxCount)
+			{
+				uint32 Pos;
+				const int32 Taken = ClaimDequeue(MaxCount - Popped, Pos);
+				if (Taken == 0) break;
+
+				for (int32 i = 0; i < Taken; ++i)
+				{
+					FCell& Cell = Cells[(Pos + i) & Mask];
+					Out.Add(MoveTemp(Cell.Value));
+					Cell.Sequence.store(Pos + i + Mask + 1, std::memory_order_release);
+				}
+				Popped += Taken;
+			}
+			return Popped;
+		}
+
+		// Approximate while other threads push or pop
+		FORCEINLINE int32 Num() const
+		{
+			const uint32 Dequeued = DequeuePos.load(std::memory_order_relaxed);
+			const uint32 Enqueued = EnqueuePos.load(std::memory_order_relaxed);
+			return FMath::Clamp(int32(Enqueued - Dequeued), 0, int32(Mask + 1));
+		}
+
+		FORCEINLINE bool IsEmpty() const { return Num() == 0; }
+
+		FORCEINLINE int32 GetCapacity() const { return int32(Mask + 1); }
+
+	private:
+		struct FCell
+		{
+			std::atomic<uint32> Sequence{ 0 };
+			T Value{};
+		};
+
+		// Claims up to Max consecutive cells that are free on this lap. A cell showing the
+		// enqueue position as its sequence cannot be taken by anyone without moving the cursor,
+		// so checking the run and then moving the cursor with one CAS is enough.
+		int32 ClaimEnqueue(int32 Max, uint32& OutPos)
+		{
+			uint32 Pos = EnqueuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				int32 Run = 0;
+				while (Run < Max && Run <= int32(Mask)
+					&& Cells[(Pos + Run) & Mask].Sequence.load(std::memory_order_acquire) == Pos + Run)
+				{
+					++Run;
+				}
+
+				if (Run == 0)
+				{
+					// Behind the consumers by a full lap means the ring is full, otherwise another
+					// producer moved the cursor
+					const uint32 Sequence = Cells[Pos & Mask].Sequence.load(std::memory_order_acquire);
+					if (int32(Sequence - Pos) < 0) return 0;
+
+					Pos = EnqueuePos.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				if (EnqueuePos.compare_exchange_weak(Pos, Pos + Run, std::memory_order_relaxed))
+				{
+					OutPos = Pos;
+					return Run;
+				}
+			}
+		}
+
+		// Claims up to Max consecutive cells that have been published, oldest first
+		int32 ClaimDequeue(int32 Max, uint32& OutPos)
+		{
+			uint32 Pos = DequeuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				int32 Run = 0;
+				while (Run < Max && Run <= int32(Mask)
+					&& Cells[(Pos + Run) & Mask].Sequence.load(std::memory_order_acquire) == Pos + Run + 1)
+				{
+					++Run;
+				}
+
+				if (Run == 0)
+				{
+					// Not published yet means empty, otherwise another consumer moved the cursor
+					const uint32 Sequence = Cells[Pos & Mask].Sequence.load(std::memory_order_acquire);
+					if (int32(Sequence - (Pos + 1)) < 0) return 0;
+
+					Pos = DequeuePos.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				if (DequeuePos.compare_exchange_weak(Pos, Pos + Run, std::memory_order_relaxed))
+				{
+					OutPos = Pos;
+					return Run;
+				}
+			}
+		}
+
+		TUniquePtr<FCell[]> Cells;
+		uint32 Mask = 0;
+
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> EnqueuePos{ 0 };
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> DequeuePos{ 0 };
+	};
+}
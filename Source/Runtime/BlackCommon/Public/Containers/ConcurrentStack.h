@@ -0,0 +1,206 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace blk
+{
+	// Bounded lock-free LIFO, a Treiber stack over a fixed array of nodes. Both the stack and the
+	// list of unused nodes have a head that carries a tag against ABA, and nodes are never freed
+	// while the stack lives, so a racing pop can read a stale link but never commit it.
+	//
+	// Has the same interface as TStack apart from Push returning false when full, so it can back
+	// TIndexPool or TObjectPool. Reserve and Clear are not thread safe.
+	template <typename T>
+	class TConcurrentStack
+	{
+	public:
+		static constexpr bool bIsConcurrent = true;
+
+		explicit TConcurrentStack(int32 InCapacity = 0)
+		{
+			Reserve(InCapacity);
+		}
+
+		TConcurrentStack(const TConcurrentStack&) = delete;
+		TConcurrentStack& operator=(const TConcurrentStack&) = delete;
+
+		// Sizes the stack for InCapacity elements and empties it
+		void Reserve(int32 InCapacity)
+		{
+			check(InCapacity >= 0);
+
+			Capacity = InCapacity;
+			Nodes = MakeUnique<FNode[]>(FMath::Max(Capacity, 1));
+			Clear();
+		}
+
+		void Clear()
+		{
+			for (int32 i = 0; i < Capacity; ++i)
+			{
+				Nodes[i].Next.store(i + 1 < Capacity ? uint32(i + 1) : None, std::memory_order_relaxed);
+			}
+
+			Head.store(Pack(None, 0), std::memory_order_relaxed);
+			FreeHead.store(Pack(Capacity > 0 ? 0 : None, 0), std::memory_order_relaxed);
+			Count.store(0, std::memory_order_relaxed);
+		}
+
+		// Returns false when every node is in use
+		template <typename U>
+		bool Push(U&& Item)
+		{
+			uint32 Node;
+			if (PopChain(FreeHead, &Node, 1) == 0) return false;
+
+			Nodes[Node].Value = Forward<U>(Item);
+			PushChain(Head, &Node, 1);
+			Count.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		bool TryPop(T& OutItem)
+		{
+			uint32 Node;
+			if (PopChain(Head, &Node, 1) == 0) return false;
+
+			OutItem = MoveTemp(Nodes[Node].Value);
+			PushChain(FreeHead, &Node, 1);
+			Count.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Pop the top element (unsafe: caller must know it is not empty, as with TStack)
+		T Pop()
+		{
+			T Item;
+			verifyf(TryPop(Item), TEXT("TConcurrentStack::Pop called on an empty stack"));
+			return Item;
+		}
+
+		// Pushes as many elements of the view as there are free nodes, the last one on top, each
+		// batch published with a single CAS. Returns how many were pushed.
+		int32 PushN(TArrayView<const T> NewItems)
+		{
+			int32 Pushed = 0;
+			while (Pushed < NewItems.Num())
+			{
+				uint32 Batch[BatchSize];
+				const int32 Claimed = PopChain(FreeHead, Batch, FMath::Min(NewItems.Num() - Pushed, BatchSize));
+				if (Claimed == 0) break;
+
+				// The chain runs from the top down, so the last item goes first
+				uint32 Chain[BatchSize];
+				for (int32 i = 0; i < Claimed; ++i)
+				{
+					Nodes[Batch[i]].Value = NewItems[Pushed + i];
+					Chain[Claimed - 1 - i] = Batch[i];
+				}
+
+				PushChain(Head, Chain, Claimed);
+				Count.fetch_add(Claimed, std::memory_order_relaxed);
+				Pushed += Claimed;
+			}
+			return Pushed;
+		}
+
+		// Pops up to MaxCount elements onto the end of Out, in the order Pop would return them.
+		// Returns how many were popped.
+		template <typename OutAllocator>
+		int32 PopN(int32 MaxCount, TArray<T, OutAllocator>& Out)
+		{
+			int32 Popped = 0;
+			while (Popped < MaxCount)
+			{
+				uint32 Batch[BatchSize];
+				const int32 Taken = PopChain(Head, Batch, FMath::Min(MaxCount - Popped, BatchSize));
+				if (Taken == 0) break;
+
+				for (int32 i = 0; i < Taken; ++i)
+				{
+					Out.Add(MoveTemp(Nodes[Batch[i]].Value));
+				}
+
+				PushChain(FreeHead, Batch, Taken);
+				Count.fetch_sub(Taken, std::memory_order_relaxed);
+				Popped += Taken;
+			}
+			return Popped;
+		}
+
+		// Approximate while other threads push or pop
+		FORCEINLINE bool IsEmpty() const { return Num() == 0; }
+		FORCEINLINE int32 Num() const { return FMath::Max(Count.load(std::memory_order_relaxed), 0); }
+
+		FORCEINLINE int32 GetCapacity() const { return Capacity; }
+
+	private:
+		static constexpr uint32 None = ~0u;
+		static constexpr int32 BatchSize = 32;
+
+		struct FNode
+		{
+			T Value{};
+			std::atomic<uint32> Next{ None };
+		};
+
+		static FORCEINLINE uint64 Pack(uint32 Node, uint32 Tag) { return (uint64(Tag) << 32) | Node; }
+		static FORCEINLINE uint32 UnpackNode(uint64 Word) { return uint32(Word); }
+		static FORCEINLINE uint32 UnpackTag(uint64 Word) { return uint32(Word >> 32); }
+
+		// Links Chain[0] -> ... -> Chain[Num - 1] in front of the list with a single CAS
+		void PushChain(std::atomic<uint64>& ListHead, const uint32* Chain, int32 Num)
+		{
+			for (int32 i = 0; i + 1 < Num; ++i)
+			{
+				Nodes[Chain[i]].Next.store(Chain[i + 1], std::memory_order_relaxed);
+			}
+
+			std::atomic<uint32>& Last = Nodes[Chain[Num - 1]].Next;
+			uint64 Current = ListHead.load(std::memory_order_relaxed);
+			do
+			{
+				Last.store(UnpackNode(Current), std::memory_order_relaxed);
+			}
+			while (!ListHead.compare_exchange_weak(
+				Current, Pack(Chain[0], UnpackTag(Current) + 1),
+				std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		// Walks up to Max links and cuts them off with a single CAS. Any change to the list
+		// bumps the tag, so a walk over links that changed underneath never commits.
+		int32 PopChain(std::atomic<uint64>& ListHead, uint32* Out, int32 Max)
+		{
+			uint64 Current = ListHead.load(std::memory_order_acquire);
+			for (;;)
+			{
+				uint32 Node = UnpackNode(Current);
+				int32 Taken = 0;
+				while (Taken < Max && Node != None)
+				{
+					Out[Taken++] = Node;
+					Node = Nodes[Node].Next.load(std::memory_order_relaxed);
+				}
+
+				if (Taken == 0) return 0;
+
+				if (ListHead.compare_exchange_weak(
+					Current, Pack(Node, UnpackTag(Current) + 1),
+					std::memory_order_acquire, std::memory_order_acquire))
+				{
+					return Taken;
+				}
+			}
+		}
+
+		int32 Capacity = 0;
+		TUniquePtr<FNode[]> Nodes;
+
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head{ 0 };
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> FreeHead{ 0 };
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<int32> Count{ 0 };
+	};
+}
@@ -0,0 +1,153 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace blk
+{
+	// Epoch based reclamation. Readers pin the domain with an FGuard while they follow pointers to
+	// shared objects, writers retire objects they have unlinked and only reuse them once every
+	// reader that could have seen them is gone.
+	//
+	// The epoch only moves forward when no reader is pinned at the previous one, so while a reader
+	// pinned at epoch E is in its guard the epoch stays at most E + 1. Anything retired at epoch R
+	// is safe to reuse once the epoch reaches R + 2. Readers are counted per epoch parity in
+	// slots picked by thread id, so a guard costs an atomic add on entry and on exit, on a line
+	// shared by few threads.
+	class BLACKCOMMON_API FEpochDomain
+	{
+		struct FSlot;
+
+	public:
+		FEpochDomain();
+		~FEpochDomain();
+
+		FEpochDomain(const FEpochDomain&) = delete;
+		FEpochDomain& operator=(const FEpochDomain&) = delete;
+
+		// Shared domain, used by TIntrusiveRefProvider
+		static FEpochDomain& Get();
+
+		// Pins the calling thread to the current epoch for its scope. Guards may nest.
+		class FGuard
+		{
+		public:
+			explicit FGuard(FEpochDomain& InDomain = FEpochDomain::Get());
+			~FGuard();
+
+			FGuard(const FGuard&) = delete;
+			FGuard& operator=(const FGuard&) = delete;
+
+		private:
+			FSlot& Slot;
+			uint32 Parity;
+		};
+
+		FORCEINLINE uint64 GetEpoch() const { return Epoch.load(std::memory_order_seq_cst); }
+
+		// Moves the epoch on if no reader is pinned at the previous one. Returns the epoch after
+		// the attempt.
+		uint64 TryAdvance();
+
+		// Whether something retired at RetireEpoch can no longer be seen by any reader
+		FORCEINLINE bool IsSafe(uint64 RetireEpoch) const { return GetEpoch() >= RetireEpoch + 2; }
+
+	private:
+		struct alignas(PLATFORM_CACHE_LINE_SIZE) FSlot
+		{
+			std::atomic<int32> Readers[2] = { 0, 0 };
+		};
+
+		// Thread ids are often aligned, so they are spread with a Fibonacci hash
+		FORCEINLINE FSlot& GetSlot()
+		{
+			const uint32 Hash = FPlatformTLS::GetCurrentThreadId() * 0x9E3779B9u;
+			return Slots[SlotShift < 32 ? Hash >> SlotShift : 0];
+		}
+
+		TUniquePtr<FSlot[]> Slots;
+		uint32 SlotShift = 32;
+
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Epoch{ 0 };
+	};
+
+	FORCEINLINE FEpochDomain::FGuard::FGuard(FEpochDomain& InDomain)
+		: Slot(InDomain.GetSlot())
+	{
+		// Counted against the epoch seen before the add, which must still be current after it
+		uint64 Observed = InDomain.GetEpoch();
+		for (;;)
+		{
+			Slot.Readers[Observed & 1].fetch_add(1, std::memory_order_seq_cst);
+
+			const uint64 Current = InDomain.GetEpoch();
+			if (Current == Observed) break;
+
+			Slot.Readers[Observed & 1].fetch_sub(1, std::memory_order_release);
+			Observed = Current;
+		}
+		Parity = uint32(Observed & 1);
+	}
+
+	FORCEINLINE FEpochDomain::FGuard::~FGuard()
+	{
+		Slot.Readers[Parity].fetch_sub(1, std::memory_order_release);
+	}
+
+	// Objects waiting out their grace period before reuse, oldest first. Not thread safe, it is
+	// meant to sit next to a free list under the owner's lock.
+	template <typename T>
+	class TEpochRetireList
+	{
+	public:
+		explicit TEpochRetireList(FEpochDomain& InDomain = FEpochDomain::Get())
+			: Domain(&InDomain) {}
+
+		// Call after the object has been unlinked from everything readers can reach
+		void Retire(const T& Item)
+		{
+			Items.Add({ Item, Domain->GetEpoch() });
+		}
+
+		// Advances the domain as far as the oldest item needs and it can, then passes every item
+		// whose grace period is over to Func. Returns how many were reclaimed.
+		template <typename FuncType>
+		int32 Reclaim(FuncType&& Func)
+		{
+			if (Items.IsEmpty()) return 0;
+
+			uint64 Epoch = Domain->GetEpoch();
+			while (Epoch < Items[0].Epoch + 2)
+			{
+				const uint64 Advanced = Domain->TryAdvance();
+				if (Advanced == Epoch) break;
+				Epoch = Advanced;
+			}
+
+			int32 Count = 0;
+			while (Count < Items.Num() && Epoch >= Items[Count].Epoch + 2)
+			{
+				Func(Items[Count].Item);
+				++Count;
+			}
+
+			Items.RemoveAt(0, Count, EAllowShrinking::No);
+			return Count;
+		}
+
+		FORCEINLINE int32 Num() const { return Items.Num(); }
+		FORCEINLINE bool IsEmpty() const { return Items.IsEmpty(); }
+
+	private:
+		struct FRetired
+		{
+			T Item;
+			uint64 Epoch;
+		};
+
+		FEpochDomain* Domain;
+		TArray<FRetired> Items;
+	};
+}
@@ -0,0 +1,244 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace blk
+{
+	// Linear allocator over a chain of blocks. Allocating bumps a pointer, nothing is freed on
+	// its own: a mark rewinds everything allocated after it, and the whole arena is rewound once
+	// per frame. Blocks are kept for the next frame, so a steady workload stops touching the heap
+	// after its first frame.
+	//
+	// Every thread has its own arena, see Get. An arena is not thread safe.
+	class BLACKCOMMON_API FFrameArena
+	{
+	public:
+		static constexpr SIZE_T DefaultBlockSize = 64 * 1024;
+		static constexpr uint32 MinAlignment = 16;
+
+		explicit FFrameArena(SIZE_T InBlockSize = DefaultBlockSize);
+		~FFrameArena();
+
+		FFrameArena(const FFrameArena&) = delete;
+		FFrameArena& operator=(const FFrameArena&) = delete;
+
+		// The calling thread's arena. It is rewound here on the first call after EndFrame that
+		// finds no mark open and no FFrameAllocator array alive on it.
+		static FFrameArena& Get();
+
+		// Starts a new frame for every thread's arena. Called at the end of each engine frame.
+		static void EndFrame();
+
+		void* Allocate(SIZE_T Size, uint32 Alignment = MinAlignment);
+
+		// Resizes the most recent allocation where it is, if it still fits its block
+		bool TryResize(void* Ptr, SIZE_T NewSize);
+
+		// Rewinds the whole arena and frees the blocks the last frame did not reach
+		void Reset();
+
+		// Bytes handed out since the last reset, alignment padding included
+		SIZE_T GetUsedBytes() const;
+
+		// Bytes held in blocks
+		FORCEINLINE SIZE_T GetReservedBytes() const { return ReservedBytes; }
+
+		// Bookkeeping of FFrameAllocator, an arena is not reset while it has live arrays
+		FORCEINLINE void AddLiveAllocation() { ++LiveAllocations; }
+		FORCEINLINE void RemoveLiveAllocation() { check(LiveAllocations > 0); --LiveAllocations; }
+
+	private:
+		friend class FFrameArenaMark;
+
+		// Header at the start of every block, the usable bytes follow it
+		struct alignas(MinAlignment) FBlock
+		{
+			FBlock* Next;
+			uint8* End;
+
+			FORCEINLINE uint8* GetData() { return reinterpret_cast<uint8*>(this + 1); }
+		};
+
+		// Moves on to a block with room for Size bytes at Alignment, reusing the next one in the
+		// chain if it is large enough
+		void* AllocateFromNextBlock(SIZE_T Size, uint32 Alignment);
+
+		void Rewind(FBlock* Block, uint8* InTop, int32 InDepth);
+
+		SIZE_T BlockSize;
+		SIZE_T ReservedBytes = 0;
+
+		FBlock* First = nullptr;
+		FBlock* Current = nullptr;
+		uint8* Top = nullptr;
+		uint8* LastAllocation = nullptr;
+		int32 Depth = 0; // Blocks up to and including Current
+		int32 PeakDepth = 0; // Deepest block reached since the last reset
+
+		int32 OpenMarks = 0;
+		int32 LiveAllocations = 0;
+		uint32 Frame = 0;
+	};
+
+	// Rewinds an arena to where it was when the mark was taken. Everything allocated from the
+	// arena in the scope of the mark must be dead by the time it goes.
+	class BLACKCOMMON_API FFrameArenaMark
+	{
+	public:
+		explicit FFrameArenaMark(FFrameArena& InArena = FFrameArena::Get());
+		~FFrameArenaMark();
+
+		FFrameArenaMark(const FFrameArenaMark&) = delete;
+		FFrameArenaMark& operator=(const FFrameArenaMark&) = delete;
+
+	private:
+		FFrameArena& Arena;
+		FFrameArena::FBlock* Block;
+		uint8* Top;
+		int32 Depth;
+		int32 LiveAllocations;
+	};
+
+	// TArray allocator policy over the calling thread's FFrameArena, for temporaries that die
+	// within the frame, usually in the scope of an FFrameArenaMark:
+	//
+	//	FFrameArenaMark Mark;
+	//	TArray<FIntPoint, FFrameAllocator> Indices;
+	//
+	// Growth moves the elements into a new allocation unless the array is the last thing
+	// allocated, the old one is only reclaimed by the mark or the frame reset. An array must stay
+	// on the thread that first allocated it.
+	class FFrameAllocator
+	{
+	public:
+		using SizeType = int32;
+
+		enum { NeedsElementType = false };
+		enum { RequireRangeCheck = true };
+
+		class ForAnyElementType
+		{
+		public:
+			ForAnyElementType() = default;
+
+			FORCEINLINE ~ForAnyElementType()
+			{
+				if (Data) Arena->RemoveLiveAllocation();
+			}
+
+			ForAnyElementType(const ForAnyElementType&) = delete;
+			ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+			FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+			{
+				check(this != &Other);
+
+				if (Data) Arena->RemoveLiveAllocation();
+				Data = Other.Data;
+				Arena = Other.Arena;
+				Other.Data = nullptr;
+				Other.Arena = nullptr;
+			}
+
+			FORCEINLINE FScriptContainerElement* GetAllocation() const { return Data; }
+
+			FORCEINLINE void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+			{
+				ResizeAllocation(PreviousNumElements, NumElements, NumBytesPerElement, FFrameArena::MinAlignment);
+			}
+
+			void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement)
+			{
+				if (NumElements == 0)
+				{
+					if (Data) Arena->RemoveLiveAllocation();
+					Data = nullptr;
+					Arena = nullptr;
+					return;
+				}
+
+				const SIZE_T NewBytes = SIZE_T(NumElements) * NumBytesPerElement;
+				if (!Data)
+				{
+					Arena = &FFrameArena::Get();
+					Arena->AddLiveAllocation();
+				}
+				else
+				{
+					checkSlow(Arena == &FFrameArena::Get());
+					if (Arena->TryResize(Data, NewBytes)) return;
+				}
+
+				void* NewData = Arena->Allocate(NewBytes, FMath::Max(AlignmentOfElement, FFrameArena::MinAlignment));
+				if (Data)
+				{
+					FMemory::Memcpy(NewData, Data, SIZE_T(FMath::Min(PreviousNumElements, NumElements)) * NumBytesPerElement);
+				}
+				Data = reinterpret_cast<FScriptContainerElement*>(NewData);
+			}
+
+			FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+			{
+				return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false);
+			}
+
+			FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) const
+			{
+				return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, AlignmentOfElement);
+			}
+
+			FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+			{
+				return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+			}
+
+			FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) const
+			{
+				return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, AlignmentOfElement);
+			}
+
+			FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+			{
+				return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+			}
+
+			FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) const
+			{
+				return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, AlignmentOfElement);
+			}
+
+			FORCEINLINE SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+			{
+				return SIZE_T(NumAllocatedElements) * NumBytesPerElement;
+			}
+
+			FORCEINLINE bool HasAllocation() const { return Data != nullptr; }
+
+			FORCEINLINE SizeType GetInitialCapacity() const { return 0; }
+
+		private:
+			FScriptContainerElement* Data = nullptr;
+			FFrameArena* Arena = nullptr;
+		};
+
+		template <typename ElementType>
+		class ForElementType : public ForAnyElementType
+		{
+		public:
+			FORCEINLINE ElementType* GetAllocation() const
+			{
+				return reinterpret_cast<ElementType*>(ForAnyElementType::GetAllocation());
+			}
+		};
+	};
+}
+
+template <>
+struct TAllocatorTraits<blk::FFrameAllocator> : TAllocatorTraitsBase<blk::FFrameAllocator>
+{
+	enum { SupportsMove = true };
+	enum { IsZeroConstruct = true };
+	enum { SupportsElementAlignment = true };
+};
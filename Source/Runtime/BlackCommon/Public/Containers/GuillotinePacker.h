@@ -0,0 +1,49 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace blk
+{
+	// Rectangle packer over a fixed Width x Height area. Allocations pick the free rect with the
+	// least leftover area and split the remainder along the shorter axis. Freed rects are merged
+	// with free neighbours that share a full edge, so space can be reused by larger requests.
+	class BLACKCOMMON_API FGuillotinePacker
+	{
+	public:
+		FGuillotinePacker() = default;
+		FGuillotinePacker(int32 InWidth, int32 InHeight) { Init(InWidth, InHeight); }
+
+		// Resets the packer to a single free rect covering the whole area
+		void Init(int32 InWidth, int32 InHeight);
+
+		// Returns false if no free rect can hold Width x Height
+		bool Allocate(int32 InWidth, int32 InHeight, FIntRect& OutRect);
+
+		// Returns a rect previously handed out by Allocate
+		void Free(const FIntRect& Rect);
+
+		// Total free area
+		FORCEINLINE int64 GetFreeArea() const { return FreeArea; }
+
+		// Area of the single largest free rect
+		int64 GetLargestFreeArea() const;
+
+		// 0 when all free space is one rect, approaching 1 as it splinters into small rects
+		float GetFragmentation() const;
+
+		FORCEINLINE int32 GetWidth() const { return Width; }
+		FORCEINLINE int32 GetHeight() const { return Height; }
+		FORCEINLINE int32 GetFreeRectCount() const { return FreeRects.Num(); }
+
+	private:
+		// Merges FreeRects[Index] with neighbours until nothing more can be merged
+		void MergeFrom(int32 Index);
+
+		int32 Width = 0;
+		int32 Height = 0;
+		int64 FreeArea = 0;
+		TArray<FIntRect> FreeRects;
+	};
+}
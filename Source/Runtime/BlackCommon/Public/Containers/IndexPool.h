@@ -3,12 +3,18 @@
 #pragma once
 
 #include "Stack.h"
+#include <atomic>
+#include <type_traits>
 
 namespace blk
 {
-	template <typename TIndex = int32>
+	// TFreeList keeps the released indices, a TStack by default. With a concurrent free list such
+	// as TConcurrentStack the pool is thread safe, Reserve it for every index that can be live.
+	template <typename TIndex = int32, typename TFreeList = TStack<TIndex>>
 	class TIndexPool
 	{
+		static constexpr bool bConcurrent = requires { requires TFreeList::bIsConcurrent; };
+
 	public:
 		TIndexPool()
 		{
@@ -17,13 +23,51 @@ namespace blk
 
 		TIndex Acquire()
 		{
-			if (Indices.IsEmpty()) return Next++;
-			return Indices.Pop();
+			TIndex Index;
+			if (Indices.TryPop(Index)) return Index;
+			return Next++;
 		}
 
 		void Release(TIndex Index)
 		{
-			Indices.Push(Index);
+			if constexpr (bConcurrent)
+			{
+				verifyf(Indices.Push(Index), TEXT("TIndexPool: the free list is full, Reserve it for every index"));
+			}
+			else
+			{
+				Indices.Push(Index);
+			}
+		}
+
+		// Acquire Count indices onto the end of OutIndices, released ones first
+		template <typename OutAllocator>
+		void AcquireN(int32 Count, TArray<TIndex, OutAllocator>& OutIndices)
+		{
+			Count -= Indices.PopN(Count, OutIndices);
+			if (Count <= 0) return;
+
+			const TIndex First = TIndex((Next += TIndex(Count)) - TIndex(Count));
+			for (int32 i = 0; i < Count; ++i)
+			{
+				OutIndices.Add(TIndex(First + i));
+			}
+		}
+
+		void ReleaseN(TArrayView<const TIndex> Released)
+		{
+			verifyf(Indices.PushN(Released) == Released.Num(), TEXT("TIndexPool: the free list is full, Reserve it for every index"));
+		}
+
+		// Sizes the free list for Count released indices. Concurrent free lists are emptied when
+		// resized, so they may only be reserved before any index is released.
+		void Reserve(int32 Count)
+		{
+			if constexpr (bConcurrent)
+			{
+				checkf(Indices.IsEmpty(), TEXT("TIndexPool: Reserve would drop the released indices of a concurrent free list"));
+			}
+			Indices.Reserve(Count);
 		}
 
 		// Reset the pool to start fresh (optionally with a given max index)
@@ -34,7 +78,7 @@ namespace blk
 		}
 
 	private:
-		TIndex Next;
-		TStack<TIndex> Indices;
+		std::conditional_t<bConcurrent, std::atomic<TIndex>, TIndex> Next;
+		TFreeList Indices;
 	};
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "IndexPool.h"
+#include "QuadtreeAllocator.h"
 #include <type_traits>
 
 namespace blk
@@ -27,6 +28,18 @@ namespace blk
 		void SetWidth(TIndex InWidth)
 		{
 			Width = InWidth;
+			bMorton = false;
+			Clear();
+		}
+
+		// Bounded Z-order mode backed by a quadtree buddy allocator. Indices acquired together are
+		// carved from the same small block, so they stay close in 2D, and whole regions can be
+		// reserved.
+		void SetMortonExtent(TIndex InWidth, TIndex InHeight)
+		{
+			Width = InWidth;
+			Height = InHeight;
+			bMorton = true;
 			Clear();
 		}
 
@@ -34,6 +47,13 @@ namespace blk
 		{
 			// Make sure the width has been initialized
 			check(Width != 0);
+
+			if (bMorton)
+			{
+				FIntPoint Tile;
+				verifyf(Quadtree.AllocateTile(Tile), TEXT("TIndexPool2D: all %d x %d indices are in use"), int32(Width), int32(Height));
+				return ToIndices(Tile);
+			}
 			
 			if (Indices.IsEmpty())
 			{
@@ -46,17 +66,59 @@ namespace blk
 
 		void Release(TIndices Index)
 		{
+			if (bMorton)
+			{
+				Quadtree.FreeTile(FIntPoint(int32(Index.X), int32(Index.Y)));
+				return;
+			}
+
 			Indices.Push(Index);
 		}
 
+		// Reserves Size adjacent indices in Morton mode. OutOrigin is the region's lowest index.
+		bool AcquireRegion(TIndices Size, TIndices& OutOrigin)
+		{
+			check(bMorton);
+
+			FIntPoint Origin;
+			if (!Quadtree.AllocateRegion(FIntPoint(int32(Size.X), int32(Size.Y)), Origin)) return false;
+
+			OutOrigin = ToIndices(Origin);
+			return true;
+		}
+
+		// Returns a region from AcquireRegion
+		void ReleaseRegion(TIndices Origin, TIndices Size)
+		{
+			check(bMorton);
+			Quadtree.FreeRegion(FIntPoint(int32(Origin.X), int32(Origin.Y)), FIntPoint(int32(Size.X), int32(Size.Y)));
+		}
+
+		// Free indices left in Morton mode
+		int32 GetFreeCount() const
+		{
+			check(bMorton);
+			return Quadtree.GetFreeTileCount();
+		}
+
 		// Reset the pool to start fresh (optionally with a given max index)
 		void Clear(TIndices Start = FIntPoint())
 		{
 			Next = Start;
 			Indices.Clear();
+
+			if (bMorton) Quadtree.Init(int32(Width), int32(Height));
 		}
 
 	private:
+		static TIndices ToIndices(FIntPoint Point)
+		{
+			TIndices Out;
+			Out.X = TIndex(Point.X);
+			Out.Y = TIndex(Point.Y);
+			return Out;
+		}
+
 		void IncrementNext()
 		{
 			++Next.X;
@@ -70,7 +132,10 @@ namespace blk
 		}
 
 		TIndex Width{ 0 };
+		TIndex Height{ 0 };
+		bool bMorton = false;
 		TIndices Next;
 		TStack<TIndices> Indices;
+		FQuadtreeAllocator Quadtree;
 	};
 }
\ No newline at end of file
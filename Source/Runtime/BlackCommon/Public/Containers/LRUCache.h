@@ -0,0 +1,385 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/IntrusiveDoubleLinkedList.h"
+#include "Containers/EpochDomain.h"
+#include "HAL/PlatformProcess.h"
+#include "Templates/IntrusiveRefCounter.h"
+#include "Templates/IntrusiveRefCountable.h"
+#include "Templates/Function.h"
+
+namespace blk
+{
+	// Counters of a TLRUCache, accumulated since construction or the last ResetStats
+	struct FLRUCacheStats
+	{
+		int64 Hits = 0;
+		int64 Misses = 0;
+		int64 Evictions = 0;
+
+		double GetHitRate() const
+		{
+			return Hits + Misses > 0 ? double(Hits) / double(Hits + Misses) : 0.0;
+		}
+	};
+
+	// Key value cache that evicts least recently released entries once over capacity, with the
+	// pinning model of ULRUTextureAtlas: lookups return an FPin (a TIntrusiveRefCounter on the
+	// entry), and pinned entries are never evicted. The first pin takes the entry off its LRU
+	// and the last one puts it back at the tail.
+	//
+	// Keys are spread over lock-striped shards, each with its own map, LRU and share of the
+	// capacity, so threads on different keys rarely contend. Recency is kept per shard and only
+	// moves on the last release, so it is approximate, but repeated hits on a pinned entry never
+	// touch the list. Capacity counts entries, or the weight Weigher gives each value (bytes,
+	// say). Pinned entries may keep a shard over its share until they are released.
+	//
+	// Evicted and removed entries are freed after an FEpochDomain grace period, since a thread
+	// dropping the last pin may still be in OnLastRelease. Pins must not outlive the cache.
+	template <typename KeyType, typename ValueType>
+	class TLRUCache
+	{
+		struct FShard;
+
+	public:
+		class FEntry :
+			public TIntrusiveDoubleLinkedList<FEntry>::NodeType,
+			public TIntrusiveRefCountable<
+				FEntry,
+				ERefCountThreading::SequentiallyConsistent,
+				ERefCountHooks::OnFirstRef,
+				ERefCountWeakRefs::None>
+		{
+		public:
+			FEntry(FShard& InShard, const KeyType& InKey, ValueType&& InValue, int64 InWeight)
+				: Shard(InShard), Key(InKey), Value(MoveTemp(InValue)), Weight(InWeight) {}
+
+			FORCEINLINE const KeyType& GetKey() const { return Key; }
+			FORCEINLINE const ValueType& GetValue() const { return Value; }
+			FORCEINLINE int64 GetWeight() const { return Weight; }
+
+			// Entries are only pinned from zero under the shard lock
+			void OnFirstRef() { if (this->IsInList()) this->Remove(); }
+
+			void OnLastRelease() { Shard.Release(*this); }
+
+		private:
+			friend class TLRUCache;
+
+			FShard& Shard;
+			KeyType Key;
+			ValueType Value;
+			int64 Weight;
+			bool bInMap = true; // Cleared once removed or replaced, guarded by the shard lock
+		};
+
+		using FPin = TIntrusiveRefCounter<FEntry>;
+
+		// Weigher returns the weight of a value, every entry weighs 1 without one. ShardCount is
+		// rounded up to a power of two, 0 picks one from the core count.
+		explicit TLRUCache(
+			int64 InCapacity,
+			TFunction<int64(const ValueType&)> InWeigher = nullptr,
+			int32 InShardCount = 0)
+			: Weigher(MoveTemp(InWeigher))
+		{
+			int32 Count = InShardCount > 0 ? InShardCount : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+			Count = FMath::Clamp(int32(FMath::RoundUpToPowerOfTwo(uint32(Count))), 1, 64);
+
+			// Every shard should have room for a few entries
+			while (Count > 1 && InCapacity / Count < 4) Count /= 2;
+
+			Shards = MakeUnique<FShard[]>(Count);
+			ShardShift = 32 - FMath::FloorLog2(Count);
+			SetCapacity(InCapacity);
+		}
+
+		~TLRUCache()
+		{
+			const int32 Count = GetShardCount();
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Shards[i].DeleteAll();
+			}
+		}
+
+		TLRUCache(const TLRUCache&) = delete;
+		TLRUCache& operator=(const TLRUCache&) = delete;
+
+		// Pinned entry for Key, or null
+		FPin Find(const KeyType& Key)
+		{
+			return GetShard(Key).Find(Key);
+		}
+
+		// Adds or replaces the value for Key, evicting unpinned entries as needed. A replaced
+		// entry stays valid for the pins already on it.
+		FPin Add(const KeyType& Key, ValueType Value)
+		{
+			const int64 Weight = GetWeight(Value);
+			return GetShard(Key).Add(Key, MoveTemp(Value), Weight, true);
+		}
+
+		// Pinned entry for Key. On a miss Producer is called as ValueType() outside the shard lock,
+		// and if another thread added the key meanwhile its entry is returned instead.
+		template <typename ProducerType>
+		FPin FindOrAdd(const KeyType& Key, ProducerType&& Producer)
+		{
+			FShard& Shard = GetShard(Key);
+			if (FPin Found = Shard.Find(Key)) return Found;
+
+			ValueType Value = Producer();
+			const int64 Weight = GetWeight(Value);
+			return Shard.Add(Key, MoveTemp(Value), Weight, false);
+		}
+
+		// Drops Key from the cache. Pinned entries are freed once their last pin is released.
+		bool Remove(const KeyType& Key)
+		{
+			return GetShard(Key).Remove(Key);
+		}
+
+		// Evicts every unpinned entry and frees those whose grace period is over
+		void Empty()
+		{
+			const int32 Count = GetShardCount();
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Shards[i].Trim(0);
+			}
+		}
+
+		// Evicts down to the capacity and frees entries whose grace period is over
+		void Trim()
+		{
+			const int32 Count = GetShardCount();
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Shards[i].Trim(-1);
+			}
+		}
+
+		// Takes effect on the next Add or Trim
+		void SetCapacity(int64 InCapacity)
+		{
+			Capacity = InCapacity;
+
+			const int32 Count = GetShardCount();
+			const int64 ShardCapacity = FMath::Max<int64>((InCapacity + Count - 1) / Count, 1);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				FScopeLock Lock(&Shards[i].Mutex);
+				Shards[i].Capacity = ShardCapacity;
+			}
+		}
+
+		FORCEINLINE int64 GetCapacity() const { return Capacity; }
+		FORCEINLINE int32 GetShardCount() const { return 1 << (32 - ShardShift); }
+
+		int32 Num() const
+		{
+			int32 Result = 0;
+			ForEachShard([&Result](const FShard& Shard) { Result += Shard.Map.Num(); });
+			return Result;
+		}
+
+		// Total weight of the entries in the cache, the entry count without a Weigher
+		int64 GetTotalWeight() const
+		{
+			int64 Result = 0;
+			ForEachShard([&Result](const FShard& Shard) { Result += Shard.Weight; });
+			return Result;
+		}
+
+		FLRUCacheStats GetStats() const
+		{
+			FLRUCacheStats Result;
+			ForEachShard([&Result](const FShard& Shard)
+			{
+				Result.Hits += Shard.Stats.Hits;
+				Result.Misses += Shard.Stats.Misses;
+				Result.Evictions += Shard.Stats.Evictions;
+			});
+			return Result;
+		}
+
+		void ResetStats()
+		{
+			const int32 Count = GetShardCount();
+			for (int32 i = 0; i < Count; ++i)
+			{
+				FScopeLock Lock(&Shards[i].Mutex);
+				Shards[i].Stats = FLRUCacheStats();
+			}
+		}
+
+	private:
+		struct alignas(PLATFORM_CACHE_LINE_SIZE) FShard
+		{
+			mutable FCriticalSection Mutex;
+			TMap<KeyType, FEntry*> Map;
+			TIntrusiveDoubleLinkedList<FEntry> LRU; // Unpinned entries, least recently released at head
+			TEpochRetireList<FEntry*> Retired; // Unlinked entries waiting out their grace period
+			int64 Weight = 0;
+			int64 Capacity = 0;
+			FLRUCacheStats Stats;
+
+			FPin Find(const KeyType& Key)
+			{
+				FScopeLock Lock(&Mutex);
+
+				FEntry** Found = Map.Find(Key);
+				if (!Found)
+				{
+					++Stats.Misses;
+					return nullptr;
+				}
+
+				++Stats.Hits;
+				return FPin(*Found);
+			}
+
+			FPin Add(const KeyType& Key, ValueType&& Value, int64 InWeight, bool bReplace)
+			{
+				FScopeLock Lock(&Mutex);
+
+				if (FEntry** Found = Map.Find(Key))
+				{
+					if (!bReplace) return FPin(*Found);
+					UnmapLocked(**Found);
+				}
+
+				FEntry* Entry = new FEntry(*this, Key, MoveTemp(Value), InWeight);
+				Map.Add(Key, Entry);
+				Weight += InWeight;
+
+				// Pinned before evicting, so the new entry is never the one to go
+				FPin Pin(Entry);
+				TrimLocked(Capacity);
+				return Pin;
+			}
+
+			bool Remove(const KeyType& Key)
+			{
+				FScopeLock Lock(&Mutex);
+
+				FEntry** Found = Map.Find(Key);
+				if (!Found) return false;
+
+				UnmapLocked(**Found);
+				return true;
+			}
+
+			void Trim(int64 MaxWeight)
+			{
+				FScopeLock Lock(&Mutex);
+				TrimLocked(MaxWeight < 0 ? Capacity : MaxWeight);
+			}
+
+			void TrimLocked(int64 MaxWeight)
+			{
+				while (Weight > MaxWeight && !LRU.IsEmpty())
+				{
+					FEntry& Entry = *LRU.GetHead();
+					Entry.Remove();
+
+					// Linked entries are unpinned, and pins from zero are only taken under the lock
+					verify(Entry.TryRetire());
+
+					Map.Remove(Entry.Key);
+					Entry.bInMap = false;
+					Weight -= Entry.Weight;
+					++Stats.Evictions;
+					Retired.Retire(&Entry);
+				}
+
+				Retired.Reclaim([](FEntry* Entry) { delete Entry; });
+			}
+
+			// Takes the entry out of the map. Unpinned entries go right away, pinned ones on
+			// their last release.
+			void UnmapLocked(FEntry& Entry)
+			{
+				Map.Remove(Entry.Key);
+				Entry.bInMap = false;
+				Weight -= Entry.Weight;
+
+				if (Entry.TryRetire())
+				{
+					if (Entry.IsInList()) Entry.Remove();
+					Retired.Retire(&Entry);
+				}
+			}
+
+			// Called after the last pin is dropped, pinned to the epoch so the entry stays alive
+			void Release(FEntry& Entry)
+			{
+				FScopeLock Lock(&Mutex);
+
+				// Pinned again, or evicted, since the count reached zero
+				if (Entry.GetRefCount() != 0 || Entry.IsRetired()) return;
+
+				if (!Entry.bInMap)
+				{
+					verify(Entry.TryRetire());
+					Retired.Retire(&Entry);
+					return;
+				}
+
+				if (!Entry.IsInList()) LRU.AddTail(&Entry);
+			}
+
+			// No pins may be left
+			void DeleteAll()
+			{
+				FScopeLock Lock(&Mutex);
+
+				for (const TPair<KeyType, FEntry*>& Pair : Map)
+				{
+					FEntry* Entry = Pair.Value;
+					checkf(Entry->GetRefCount() == 0, TEXT("TLRUCache destroyed with pinned entries"));
+
+					if (Entry->IsInList()) Entry->Remove();
+					delete Entry;
+				}
+				Map.Empty();
+
+				// Guards are short lived, so this only waits out releases still in flight
+				while (!Retired.IsEmpty())
+				{
+					if (Retired.Reclaim([](FEntry* Entry) { delete Entry; }) == 0) FPlatformProcess::YieldThread();
+				}
+			}
+		};
+
+		FORCEINLINE int64 GetWeight(const ValueType& Value) const
+		{
+			return Weigher ? Weigher(Value) : 1;
+		}
+
+		// Keys are spread with a Fibonacci hash, the low bits are left to the shard maps
+		FORCEINLINE FShard& GetShard(const KeyType& Key) const
+		{
+			const uint32 Hash = GetTypeHash(Key) * 0x9E3779B9u;
+			return Shards[ShardShift < 32 ? Hash >> ShardShift : 0];
+		}
+
+		template <typename FuncType>
+		void ForEachShard(FuncType&& Func) const
+		{
+			const int32 Count = GetShardCount();
+			for (int32 i = 0; i < Count; ++i)
+			{
+				FScopeLock Lock(&Shards[i].Mutex);
+				Func(Shards[i]);
+			}
+		}
+
+		TFunction<int64(const ValueType&)> Weigher;
+		TUniquePtr<FShard[]> Shards;
+		uint32 ShardShift = 32;
+		int64 Capacity = 0;
+	};
+}
@@ -3,13 +3,21 @@
 #pragma once
 
 #include "Stack.h"
+#include "Templates/PooledPtr.h"
 
 namespace blk
 {
-	template <typename T>
+	// TFreeList keeps the idle objects, a TStack by default. A concurrent free list such as
+	// TConcurrentStack makes Acquire and Release thread safe, objects released while it is full
+	// are dropped. AcquirePtr stays single threaded.
+	template <typename T, typename TFreeList = TStack<T>>
 	class TObjectPool
 	{
+		static constexpr bool bConcurrent = requires { requires TFreeList::bIsConcurrent; };
+
 	public:
+		using FPooledPtr = TPooledPtr<T, TObjectPool>;
+
 		// Default constructor func
 		TObjectPool(size_t Count = 0) requires std::is_default_constructible_v<T>
 			: TObjectPool(Count, []() { return T{}; }) {}
@@ -22,16 +30,37 @@ namespace blk
 		template <typename UFactory>
 		TObjectPool(size_t Count, UFactory&& factory) : Factory(Forward<UFactory>(factory))
 		{
+			Objects.Reserve(int32(Count));
 			for (size_t i = 0; i < Count; ++i)
 			{
 				Objects.Push(this->Factory());
 			}
 		}
 
+		~TObjectPool()
+		{
+			check(FreeSlots.Num() == SlotCount); // A TPooledPtr outlived its pool
+
+			for (int32 i = 0; i < SlotCount; ++i)
+			{
+				Slots[i / SlotChunkSize][i % SlotChunkSize].GetTypedPtr()->~T();
+			}
+		}
+
 		T Acquire()
 		{
-			if (Objects.Num() == 0) return Factory();
-			return Objects.Pop();
+			if constexpr (bConcurrent)
+			{
+				// Concurrent free lists hold T by value in their cells, so it is default constructible
+				T Item;
+				if (Objects.TryPop(Item)) return Item;
+				return Factory();
+			}
+			else
+			{
+				if (Objects.IsEmpty()) return Factory();
+				return Objects.Pop();
+			}
 		}
 
 		template <typename U>
@@ -40,8 +69,53 @@ namespace blk
 			Objects.Push(Forward<U>(Item));
 		}
 
+		// Room for Count idle objects. Bounded free lists drop anything released beyond it, and are
+		// emptied when resized, so they may only be reserved while no object is idle.
+		void Reserve(int32 Count)
+		{
+			if constexpr (bConcurrent)
+			{
+				checkf(Objects.IsEmpty(), TEXT("TObjectPool: Reserve would drop the idle objects of a concurrent free list"));
+			}
+			Objects.Reserve(Count);
+		}
+
+		// Object that stays in storage owned by the pool and comes back when the handle dies.
+		// It is built by the factory once and then only reset between uses, never moved.
+		FPooledPtr AcquirePtr()
+		{
+			if (FreeSlots.IsEmpty()) return FPooledPtr(AllocateSlot(), *this);
+			return FPooledPtr(FreeSlots.Pop(), *this);
+		}
+
+		// Takes back an object from AcquirePtr, called by its handle
+		void Release(T* Object)
+		{
+			FreeSlots.Push(Object);
+		}
+
 	private:
+		static constexpr int32 SlotChunkSize = 16;
+
+		T* AllocateSlot()
+		{
+			if (SlotCount % SlotChunkSize == 0)
+			{
+				Slots.Add(MakeUnique<TTypeCompatibleBytes<T>[]>(SlotChunkSize));
+			}
+
+			// The factory's result initializes the slot directly
+			T* Object = new (Slots.Last()[SlotCount % SlotChunkSize].GetTypedPtr()) T(Factory());
+			++SlotCount;
+			return Object;
+		}
+
 		TFunction<T()> Factory;
-		TStack<T> Objects;
+		TFreeList Objects;
+
+		// Chunks keep the objects handed out by AcquirePtr at fixed addresses
+		TArray<TUniquePtr<TTypeCompatibleBytes<T>[]>> Slots;
+		int32 SlotCount = 0;
+		TStack<T*> FreeSlots;
 	};
 }
\ No newline at end of file
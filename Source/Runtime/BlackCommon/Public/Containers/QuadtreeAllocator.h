@@ -0,0 +1,56 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace blk
+{
+	// Buddy allocator over a Width x Height grid of tiles. Blocks are aligned power of two
+	// squares numbered in Z-order, so the four children of block B one level down are 4B..4B+3.
+	// Allocations take the smallest free block that fits, lowest in Z-order on its level, which
+	// keeps larger blocks whole for regions.
+	class BLACKCOMMON_API FQuadtreeAllocator
+	{
+	public:
+		FQuadtreeAllocator() = default;
+		FQuadtreeAllocator(int32 InWidth, int32 InHeight) { Init(InWidth, InHeight); }
+
+		// Frees every tile of the grid
+		void Init(int32 InWidth, int32 InHeight);
+
+		// Free tile from the smallest free block. Returns false when the grid is full.
+		bool AllocateTile(FIntPoint& OutTile);
+		void FreeTile(FIntPoint Tile);
+
+		// Reserves Size adjacent tiles from the smallest free block that holds them. The part of
+		// the block outside the region is freed again right away.
+		bool AllocateRegion(FIntPoint Size, FIntPoint& OutOrigin);
+
+		// Returns a region previously handed out by AllocateRegion
+		void FreeRegion(FIntPoint Origin, FIntPoint Size);
+
+		FORCEINLINE int32 GetFreeTileCount() const { return FreeTiles; }
+		FORCEINLINE int32 GetWidth() const { return Width; }
+		FORCEINLINE int32 GetHeight() const { return Height; }
+
+	private:
+		// Lowest free block at Level, splitting the lowest larger one if there is none
+		bool AllocateBlock(int32 Level, uint32& OutBlock);
+
+		// Frees a block and merges it with its siblings while all four are free
+		void FreeBlock(int32 Level, uint32 Block);
+
+		// Frees the quads of Block that lie inside Rect (bInside) or outside it, recursing into
+		// partly covered quads
+		void FreeCovered(int32 Level, uint32 Block, const FIntRect& Rect, bool bInside);
+
+		FIntRect GetBlockRect(int32 Level, uint32 Block) const;
+
+		int32 Width = 0;
+		int32 Height = 0;
+		int32 LevelCount = 0; // The top level is a single block covering the whole grid
+		int32 FreeTiles = 0;
+		TArray<TBitArray<>> FreeBlocks; // Per level, set while the block is free
+	};
+}
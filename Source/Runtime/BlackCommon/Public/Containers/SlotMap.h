@@ -0,0 +1,163 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "IndexPool.h"
+
+namespace blk
+{
+	// Handle to a TSlotMap value. A default handle never resolves.
+	struct FSlotHandle
+	{
+		uint32 Index = 0;
+		uint32 Generation = 0; // Zero is never handed out
+
+		FORCEINLINE bool IsNull() const { return Generation == 0; }
+
+		FORCEINLINE bool operator==(const FSlotHandle& Other) const
+		{
+			return Index == Other.Index && Generation == Other.Generation;
+		}
+
+		FORCEINLINE friend uint32 GetTypeHash(const FSlotHandle& Handle)
+		{
+			return HashCombineFast(Handle.Index, Handle.Generation);
+		}
+	};
+
+	// Values packed densely for iteration, addressed through a sparse table of slots that each
+	// carry a generation. Erasing bumps the generation, so stale handles fail the lookup with a
+	// single compare, and the last value is swapped into the hole to keep the values dense.
+	// Insert, erase and lookup are O(1). Values move on erase, so hold handles rather than
+	// pointers.
+	template <typename T>
+	class TSlotMap
+	{
+	public:
+		template <typename... ArgsType>
+		FSlotHandle Emplace(ArgsType&&... Args)
+		{
+			const int32 SlotIndex = SlotIndexPool.Acquire();
+			if (SlotIndex == Slots.Num()) Slots.AddDefaulted();
+
+			FSlot& Slot = Slots[SlotIndex];
+			Slot.DenseIndex = Values.Num();
+
+			Values.Emplace(Forward<ArgsType>(Args)...);
+			DenseToSlot.Add(SlotIndex);
+
+			return FSlotHandle{ uint32(SlotIndex), Slot.Generation };
+		}
+
+		FORCEINLINE FSlotHandle Add(const T& Value) { return Emplace(Value); }
+		FORCEINLINE FSlotHandle Add(T&& Value) { return Emplace(MoveTemp(Value)); }
+
+		// Returns false for stale or null handles
+		bool Remove(FSlotHandle Handle)
+		{
+			if (!Contains(Handle)) return false;
+
+			FSlot& Slot = Slots[Handle.Index];
+			const int32 DenseIndex = Slot.DenseIndex;
+			const int32 LastIndex = Values.Num() - 1;
+
+			// The last value fills the hole, its slot follows it
+			if (DenseIndex != LastIndex)
+			{
+				Slots[DenseToSlot[LastIndex]].DenseIndex = DenseIndex;
+				DenseToSlot[DenseIndex] = DenseToSlot[LastIndex];
+			}
+
+			Values.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+			DenseToSlot.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+
+			Slot.DenseIndex = INDEX_NONE;
+			if (++Slot.Generation == 0) Slot.Generation = 1;
+			SlotIndexPool.Release(int32(Handle.Index));
+			return true;
+		}
+
+		FORCEINLINE bool Contains(FSlotHandle Handle) const
+		{
+			return Handle.Index < uint32(Slots.Num())
+				&& Slots[Handle.Index].Generation == Handle.Generation
+				&& Slots[Handle.Index].DenseIndex != INDEX_NONE;
+		}
+
+		// Nullptr for stale or null handles
+		FORCEINLINE T* Find(FSlotHandle Handle)
+		{
+			return Contains(Handle) ? &Values[Slots[Handle.Index].DenseIndex] : nullptr;
+		}
+
+		FORCEINLINE const T* Find(FSlotHandle Handle) const
+		{
+			return Contains(Handle) ? &Values[Slots[Handle.Index].DenseIndex] : nullptr;
+		}
+
+		FORCEINLINE T& operator[](FSlotHandle Handle)
+		{
+			check(Contains(Handle));
+			return Values[Slots[Handle.Index].DenseIndex];
+		}
+
+		FORCEINLINE const T& operator[](FSlotHandle Handle) const
+		{
+			check(Contains(Handle));
+			return Values[Slots[Handle.Index].DenseIndex];
+		}
+
+		// Handle of the value at DenseIndex in GetValues()
+		FORCEINLINE FSlotHandle GetHandle(int32 DenseIndex) const
+		{
+			const int32 SlotIndex = DenseToSlot[DenseIndex];
+			return FSlotHandle{ uint32(SlotIndex), Slots[SlotIndex].Generation };
+		}
+
+		// Live values, contiguous and in no particular order
+		FORCEINLINE TArrayView<T> GetValues() { return Values; }
+		FORCEINLINE TArrayView<const T> GetValues() const { return Values; }
+
+		FORCEINLINE int32 Num() const { return Values.Num(); }
+		FORCEINLINE bool IsEmpty() const { return Values.IsEmpty(); }
+
+		void Reserve(int32 Number)
+		{
+			Values.Reserve(Number);
+			DenseToSlot.Reserve(Number);
+			Slots.Reserve(Number);
+		}
+
+		// Removes every value. Outstanding handles go stale, slots are kept for reuse.
+		void Clear()
+		{
+			for (const int32 SlotIndex : DenseToSlot)
+			{
+				FSlot& Slot = Slots[SlotIndex];
+				Slot.DenseIndex = INDEX_NONE;
+				if (++Slot.Generation == 0) Slot.Generation = 1;
+				SlotIndexPool.Release(SlotIndex);
+			}
+
+			Values.Reset();
+			DenseToSlot.Reset();
+		}
+
+		FORCEINLINE T* begin() { return Values.GetData(); }
+		FORCEINLINE T* end() { return Values.GetData() + Values.Num(); }
+		FORCEINLINE const T* begin() const { return Values.GetData(); }
+		FORCEINLINE const T* end() const { return Values.GetData() + Values.Num(); }
+
+	private:
+		struct FSlot
+		{
+			int32 DenseIndex = INDEX_NONE;
+			uint32 Generation = 1;
+		};
+
+		TArray<T> Values;
+		TArray<int32> DenseToSlot; // Slot of each value, parallel to Values
+		TArray<FSlot> Slots;
+		TIndexPool<int32> SlotIndexPool; // Free slots, handed out again with a new generation
+	};
+}
@@ -4,7 +4,9 @@
 
 namespace blk
 {
-	template<typename T>
+	// Allocator is any TArray allocator, e.g. TInlineAllocator<N> for short lived stacks that
+	// should not touch the heap, or TFixedAllocator<N> for a hard upper bound.
+	template<typename T, typename Allocator = FDefaultAllocator>
 	class TStack
 	{
 	public:
@@ -15,11 +17,53 @@ namespace blk
 			Items.Add(Forward<U>(Item));
 		}
 
+		// Push every element of the view, the last one ends up on top. Returns how many were
+		// pushed, which is all of them for TStack.
+		int32 PushN(TArrayView<const T> NewItems)
+		{
+			Items.Append(NewItems.GetData(), NewItems.Num());
+			return NewItems.Num();
+		}
+
 		// Pop the top element (unsafe: caller must check IsEmpty first)
 		T Pop()
 		{
 			check(!IsEmpty()); // Use check or ensure if you want runtime safety
-			return Items.Pop(); // Returns by value, move or copy depending on T
+
+			// Stacks used as free lists refill right away, so the allocation is kept
+			return Items.Pop(EAllowShrinking::No); // Returns by value, move or copy depending on T
+		}
+
+		// Pop the top element into OutItem, returns false when the stack is empty
+		bool TryPop(T& OutItem)
+		{
+			if (IsEmpty()) return false;
+
+			OutItem = Items.Pop(EAllowShrinking::No);
+			return true;
+		}
+
+		// Pop up to Count elements onto the end of Out, in the order Pop would return them.
+		// Returns how many were popped.
+		template <typename OutAllocator>
+		int32 PopN(int32 Count, TArray<T, OutAllocator>& Out)
+		{
+			Count = FMath::Min(Count, Items.Num());
+			const int32 First = Items.Num() - Count;
+
+			Out.Reserve(Out.Num() + Count);
+			for (int32 i = Items.Num() - 1; i >= First; --i)
+			{
+				Out.Add(MoveTemp(Items[i]));
+			}
+
+			Items.RemoveAt(First, Count, EAllowShrinking::No);
+			return Count;
+		}
+
+		void Reserve(int32 Number)
+		{
+			Items.Reserve(Number);
 		}
 
 		// Peek at the top element (non-const)
@@ -55,6 +99,6 @@ namespace blk
 		}
 
 	private:
-		TArray<T> Items;
+		TArray<T, Allocator> Items;
 	};
 }
\ No newline at end of file
@@ -2,6 +2,24 @@
 
 #pragma once
 
+#include "HAL/Platform.h"
+#include <type_traits>
+
+// BMI2 pdep/pext for Morton codes, off unless the target sets BLK_ARRAY_INDEXING_USE_BMI2=1. They
+// are microcoded on AMD before Zen 3 and much slower there than the magic bit path, so only opt in
+// when every target CPU runs them natively. MSVC has no BMI2 switch, but every AVX2 target also
+// has BMI2.
+#ifndef BLK_ARRAY_INDEXING_USE_BMI2
+#define BLK_ARRAY_INDEXING_USE_BMI2 0
+#endif
+
+#if BLK_ARRAY_INDEXING_USE_BMI2 && PLATFORM_CPU_X86_FAMILY && (defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#include <immintrin.h>
+#define BLK_ARRAY_INDEXING_BMI2 1
+#else
+#define BLK_ARRAY_INDEXING_BMI2 0
+#endif
+
 namespace blk
 {
 	// Returns total number of elements in a 2D grid (Width x Height)
@@ -44,12 +62,12 @@ namespace blk
 		OutX = Remainder % Width;
 	}
 
-	// Adjust a 1D index by offsetting by (X,Y) in a 2D grid
+	// Adjust a 1D index by offsetting by (X,Y) in a 2D grid, without bounds checks (see TGridShape::GetNeighbor)
 	inline constexpr int32 AdjustIndex2D(const int32 Index, const int32 Width, int32 OffsetX, int32 OffsetY) {
 		return Index + Index2DTo1D(OffsetX, OffsetY, Width);
 	}
 
-	// Adjust a 1D index by offsetting by (X,Y,Z) in a 3D grid
+	// Adjust a 1D index by offsetting by (X,Y,Z) in a 3D grid, without bounds checks (see TGridShape::GetNeighbor)
 	inline constexpr int32 AdjustIndex3D(
 		const int32 Index, const int32 Width, const int32 Height,
 		const int32 OffsetX, const int32 OffsetY, const int32 OffsetZ) {
@@ -61,4 +79,201 @@ namespace blk
 		int32 Pad = Alignment - (Count % Alignment);
 		return (Pad == Alignment) ? 0 : Pad;
 	}
+
+	// Spreads the low 16 bits of Value onto the even bits
+	inline constexpr uint32 MortonSpread2D(uint32 Value) {
+		Value &= 0x0000FFFF;
+		Value = (Value | (Value << 8)) & 0x00FF00FF;
+		Value = (Value | (Value << 4)) & 0x0F0F0F0F;
+		Value = (Value | (Value << 2)) & 0x33333333;
+		Value = (Value | (Value << 1)) & 0x55555555;
+		return Value;
+	}
+
+	// Gathers the even bits of Value into the low 16 bits
+	inline constexpr uint32 MortonCompact2D(uint32 Value) {
+		Value &= 0x55555555;
+		Value = (Value | (Value >> 1)) & 0x33333333;
+		Value = (Value | (Value >> 2)) & 0x0F0F0F0F;
+		Value = (Value | (Value >> 4)) & 0x00FF00FF;
+		Value = (Value | (Value >> 8)) & 0x0000FFFF;
+		return Value;
+	}
+
+	// Spreads the low 10 bits of Value onto every third bit
+	inline constexpr uint32 MortonSpread3D(uint32 Value) {
+		Value &= 0x000003FF;
+		Value = (Value | (Value << 16)) & 0xFF0000FF;
+		Value = (Value | (Value << 8)) & 0x0300F00F;
+		Value = (Value | (Value << 4)) & 0x030C30C3;
+		Value = (Value | (Value << 2)) & 0x09249249;
+		return Value;
+	}
+
+	// Gathers every third bit of Value into the low 10 bits
+	inline constexpr uint32 MortonCompact3D(uint32 Value) {
+		Value &= 0x09249249;
+		Value = (Value | (Value >> 2)) & 0x030C30C3;
+		Value = (Value | (Value >> 4)) & 0x0300F00F;
+		Value = (Value | (Value >> 8)) & 0xFF0000FF;
+		Value = (Value | (Value >> 16)) & 0x000003FF;
+		return Value;
+	}
+
+	// Interleaves 16 bit coordinates (X,Y) into a Z-order index, X in the even bits
+	inline constexpr uint32 MortonEncode2D(const uint32 X, const uint32 Y) {
+#if BLK_ARRAY_INDEXING_BMI2
+		if (!std::is_constant_evaluated()) return _pdep_u32(X, 0x55555555) | _pdep_u32(Y, 0xAAAAAAAA);
+#endif
+		return MortonSpread2D(X) | (MortonSpread2D(Y) << 1);
+	}
+
+	// Converts a Z-order index back into 2D coordinates (X,Y)
+	inline constexpr void MortonDecode2D(const uint32 Code, uint32& OutX, uint32& OutY) {
+#if BLK_ARRAY_INDEXING_BMI2
+		if (!std::is_constant_evaluated()) {
+			OutX = _pext_u32(Code, 0x55555555);
+			OutY = _pext_u32(Code, 0xAAAAAAAA);
+			return;
+		}
+#endif
+		OutX = MortonCompact2D(Code);
+		OutY = MortonCompact2D(Code >> 1);
+	}
+
+	// Interleaves 10 bit coordinates (X,Y,Z) into a Z-order index, X in the lowest bit
+	inline constexpr uint32 MortonEncode3D(const uint32 X, const uint32 Y, const uint32 Z) {
+#if BLK_ARRAY_INDEXING_BMI2
+		if (!std::is_constant_evaluated()) {
+			return _pdep_u32(X, 0x09249249) | _pdep_u32(Y, 0x12492492) | _pdep_u32(Z, 0x24924924);
+		}
+#endif
+		return MortonSpread3D(X) | (MortonSpread3D(Y) << 1) | (MortonSpread3D(Z) << 2);
+	}
+
+	// Converts a 3D Z-order index back into coordinates (X,Y,Z)
+	inline constexpr void MortonDecode3D(const uint32 Code, uint32& OutX, uint32& OutY, uint32& OutZ) {
+#if BLK_ARRAY_INDEXING_BMI2
+		if (!std::is_constant_evaluated()) {
+			OutX = _pext_u32(Code, 0x09249249);
+			OutY = _pext_u32(Code, 0x12492492);
+			OutZ = _pext_u32(Code, 0x24924924);
+			return;
+		}
+#endif
+		OutX = MortonCompact3D(Code);
+		OutY = MortonCompact3D(Code >> 1);
+		OutZ = MortonCompact3D(Code >> 2);
+	}
+
+	// Converts (X,Y) in a 2^Order square (Order <= 16) to its distance along the Hilbert curve
+	inline constexpr uint32 HilbertEncode2D(uint32 X, uint32 Y, const int32 Order) {
+		uint32 Index = 0;
+		for (uint32 S = (1u << Order) >> 1; S > 0; S >>= 1) {
+			const uint32 RX = (X & S) ? 1 : 0;
+			const uint32 RY = (Y & S) ? 1 : 0;
+			Index += S * S * ((3 * RX) ^ RY);
+
+			// Rotates the quadrant so the sub curve starts at its origin
+			if (RY == 0) {
+				if (RX == 1) {
+					X ^= S - 1;
+					Y ^= S - 1;
+				}
+				const uint32 T = X;
+				X = Y;
+				Y = T;
+			}
+		}
+		return Index;
+	}
+
+	// Converts a distance along the Hilbert curve in a 2^Order square back into (X,Y)
+	inline constexpr void HilbertDecode2D(uint32 Index, const int32 Order, uint32& OutX, uint32& OutY) {
+		uint32 X = 0;
+		uint32 Y = 0;
+		for (uint32 S = 1; S < (1u << Order); S <<= 1) {
+			const uint32 RX = 1 & (Index >> 1);
+			const uint32 RY = 1 & (Index ^ RX);
+
+			if (RY == 0) {
+				if (RX == 1) {
+					X ^= S - 1;
+					Y ^= S - 1;
+				}
+				const uint32 T = X;
+				X = Y;
+				Y = T;
+			}
+
+			X += S * RX;
+			Y += S * RY;
+			Index >>= 2;
+		}
+		OutX = X;
+		OutY = Y;
+	}
+
+	// Converts (X,Y,Z) in a 2^Order cube (Order <= 10) to its distance along the Hilbert curve.
+	// Order 0 is the single cell cube, as in the 2D version.
+	// Skilling's transform from axes to the transposed index, then interleaved with X highest.
+	inline constexpr uint32 HilbertEncode3D(uint32 X, uint32 Y, uint32 Z, const int32 Order) {
+		uint32 Axes[3] = { X, Y, Z };
+
+		for (uint32 Q = (1u << Order) >> 1; Q > 1; Q >>= 1) {
+			const uint32 P = Q - 1;
+			for (int32 i = 0; i < 3; ++i) {
+				if (Axes[i] & Q) {
+					Axes[0] ^= P;
+				}
+				else {
+					const uint32 T = (Axes[0] ^ Axes[i]) & P;
+					Axes[0] ^= T;
+					Axes[i] ^= T;
+				}
+			}
+		}
+
+		// Gray encode
+		Axes[1] ^= Axes[0];
+		Axes[2] ^= Axes[1];
+		uint32 T = 0;
+		for (uint32 Q = (1u << Order) >> 1; Q > 1; Q >>= 1) {
+			if (Axes[2] & Q) T ^= Q - 1;
+		}
+		Axes[0] ^= T;
+		Axes[1] ^= T;
+		Axes[2] ^= T;
+
+		return (MortonSpread3D(Axes[0]) << 2) | (MortonSpread3D(Axes[1]) << 1) | MortonSpread3D(Axes[2]);
+	}
+
+	// Converts a distance along the 3D Hilbert curve in a 2^Order cube back into (X,Y,Z)
+	inline constexpr void HilbertDecode3D(const uint32 Index, const int32 Order, uint32& OutX, uint32& OutY, uint32& OutZ) {
+		uint32 Axes[3] = { MortonCompact3D(Index >> 2), MortonCompact3D(Index >> 1), MortonCompact3D(Index) };
+
+		// Gray decode
+		uint32 T = Axes[2] >> 1;
+		Axes[2] ^= Axes[1];
+		Axes[1] ^= Axes[0];
+		Axes[0] ^= T;
+
+		for (uint32 Q = 2; Q < (1u << Order); Q <<= 1) {
+			const uint32 P = Q - 1;
+			for (int32 i = 2; i >= 0; --i) {
+				if (Axes[i] & Q) {
+					Axes[0] ^= P;
+				}
+				else {
+					T = (Axes[0] ^ Axes[i]) & P;
+					Axes[0] ^= T;
+					Axes[i] ^= T;
+				}
+			}
+		}
+
+		OutX = Axes[0];
+		OutY = Axes[1];
+		OutZ = Axes[2];
+	}
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Array at a time versions of the ArrayIndexing conversions, vectorized with AVX2, SSE2 or NEON
+// where available. Every view passed to one call must have the same length. Coordinates and
+// indices are expected to be non negative and within the ranges of the scalar versions.
+namespace blk
+{
+	BLACKCOMMON_API void Index2DTo1DBatch(
+		TArrayView<const int32> X, TArrayView<const int32> Y,
+		int32 Width,
+		TArrayView<int32> OutIndex);
+
+	BLACKCOMMON_API void Index3DTo1DBatch(
+		TArrayView<const int32> X, TArrayView<const int32> Y, TArrayView<const int32> Z,
+		int32 Width, int32 Height,
+		TArrayView<int32> OutIndex);
+
+	BLACKCOMMON_API void Index1DTo2DBatch(
+		TArrayView<const int32> Index,
+		int32 Width,
+		TArrayView<int32> OutX, TArrayView<int32> OutY);
+
+	BLACKCOMMON_API void Index1DTo3DBatch(
+		TArrayView<const int32> Index,
+		int32 Width, int32 Height,
+		TArrayView<int32> OutX, TArrayView<int32> OutY, TArrayView<int32> OutZ);
+
+	BLACKCOMMON_API void MortonEncode2DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y,
+		TArrayView<uint32> OutCode);
+
+	BLACKCOMMON_API void MortonDecode2DBatch(
+		TArrayView<const uint32> Code,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY);
+
+	BLACKCOMMON_API void MortonEncode3DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y, TArrayView<const uint32> Z,
+		TArrayView<uint32> OutCode);
+
+	BLACKCOMMON_API void MortonDecode3DBatch(
+		TArrayView<const uint32> Code,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY, TArrayView<uint32> OutZ);
+
+	BLACKCOMMON_API void HilbertEncode2DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y,
+		int32 Order,
+		TArrayView<uint32> OutIndex);
+
+	BLACKCOMMON_API void HilbertDecode2DBatch(
+		TArrayView<const uint32> Index,
+		int32 Order,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY);
+
+	BLACKCOMMON_API void HilbertEncode3DBatch(
+		TArrayView<const uint32> X, TArrayView<const uint32> Y, TArrayView<const uint32> Z,
+		int32 Order,
+		TArrayView<uint32> OutIndex);
+
+	BLACKCOMMON_API void HilbertDecode3DBatch(
+		TArrayView<const uint32> Index,
+		int32 Order,
+		TArrayView<uint32> OutX, TArrayView<uint32> OutY, TArrayView<uint32> OutZ);
+}
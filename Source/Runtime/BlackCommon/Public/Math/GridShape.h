@@ -0,0 +1,199 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <bit>
+
+namespace blk
+{
+	// Division of non negative int32 values by a divisor fixed at runtime, as one 64 bit multiply
+	// and a shift. Power of two divisors use a multiplier of one, so they reduce to the shift.
+	class FGridDivisor
+	{
+	public:
+		FGridDivisor() = default;
+
+		explicit FGridDivisor(int32 InDivisor)
+			: Divisor(InDivisor)
+		{
+			check(InDivisor > 0);
+
+			const uint32 D = uint32(InDivisor);
+			const int32 CeilLog2 = int32(std::bit_width(D - 1));
+
+			if (std::has_single_bit(D))
+			{
+				Multiplier = 1;
+				Shift = CeilLog2;
+			}
+			else
+			{
+				// ceil(2^(32+L) / D) is exact for every numerator below 2^32 and stays under 2^33,
+				// so the product with a non negative int32 fits in 64 bits
+				Shift = 32 + CeilLog2;
+				Multiplier = ((uint64(1) << Shift) + D - 1) / D;
+			}
+		}
+
+		FORCEINLINE int32 Divide(int32 Value) const
+		{
+			checkSlow(Value >= 0);
+			return int32((uint64(uint32(Value)) * Multiplier) >> Shift);
+		}
+
+		FORCEINLINE int32 Modulo(int32 Value) const
+		{
+			return Value - Divide(Value) * Divisor;
+		}
+
+		FORCEINLINE void DivMod(int32 Value, int32& OutQuotient, int32& OutRemainder) const
+		{
+			OutQuotient = Divide(Value);
+			OutRemainder = Value - OutQuotient * Divisor;
+		}
+
+		FORCEINLINE int32 Get() const { return Divisor; }
+
+	private:
+		uint64 Multiplier = 1;
+		int32 Shift = 0;
+		int32 Divisor = 1;
+	};
+
+	// Grid dimensions known at compile time. Index conversions divide by constants, which become
+	// shifts and masks for power of two sizes and a multiply and shift otherwise.
+	template <int32 InWidth, int32 InHeight = 1, int32 InDepth = 1>
+	struct TGridShape
+	{
+		static_assert(InWidth > 0 && InHeight > 0 && InDepth > 0, "TGridShape dimensions must be positive");
+		static_assert(int64(InWidth) * InHeight * InDepth <= MAX_int32, "TGridShape must fit int32 indices");
+
+		static constexpr int32 Width = InWidth;
+		static constexpr int32 Height = InHeight;
+		static constexpr int32 Depth = InDepth;
+		static constexpr int32 SliceSize = Width * Height;
+		static constexpr int32 Num = SliceSize * Depth;
+
+		static constexpr int32 ToIndex(int32 X, int32 Y, int32 Z = 0)
+		{
+			return (Z * Height + Y) * Width + X;
+		}
+
+		static constexpr void ToCoords(int32 Index, int32& OutX, int32& OutY)
+		{
+			OutY = Divide<Width>(Index);
+			OutX = Modulo<Width>(Index);
+		}
+
+		static constexpr void ToCoords(int32 Index, int32& OutX, int32& OutY, int32& OutZ)
+		{
+			const int32 Remainder = Modulo<SliceSize>(Index);
+			OutZ = Divide<SliceSize>(Index);
+			OutY = Divide<Width>(Remainder);
+			OutX = Modulo<Width>(Remainder);
+		}
+
+		static constexpr bool Contains(int32 X, int32 Y, int32 Z = 0)
+		{
+			return uint32(X) < uint32(Width) && uint32(Y) < uint32(Height) && uint32(Z) < uint32(Depth);
+		}
+
+		// Index of the cell offset by (DX,DY,DZ) from Index, or INDEX_NONE past the grid edges
+		static constexpr int32 GetNeighbor(int32 Index, int32 DX, int32 DY, int32 DZ = 0)
+		{
+			int32 X, Y, Z;
+			ToCoords(Index, X, Y, Z);
+			return Contains(X + DX, Y + DY, Z + DZ) ? Index + ToIndex(DX, DY, DZ) : INDEX_NONE;
+		}
+
+	private:
+		// Unsigned so the compiler can drop the rounding fix up of signed division
+		template <int32 Divisor>
+		static constexpr int32 Divide(int32 Value)
+		{
+			if constexpr (std::has_single_bit(uint32(Divisor)))
+			{
+				return int32(uint32(Value) >> std::countr_zero(uint32(Divisor)));
+			}
+			else
+			{
+				return int32(uint32(Value) / uint32(Divisor));
+			}
+		}
+
+		template <int32 Divisor>
+		static constexpr int32 Modulo(int32 Value)
+		{
+			if constexpr (std::has_single_bit(uint32(Divisor)))
+			{
+				return int32(uint32(Value) & uint32(Divisor - 1));
+			}
+			else
+			{
+				return int32(uint32(Value) % uint32(Divisor));
+			}
+		}
+	};
+
+	// Runtime counterpart of TGridShape, dividing through precomputed FGridDivisors
+	class FGridShape
+	{
+	public:
+		FGridShape() = default;
+
+		FGridShape(int32 InWidth, int32 InHeight = 1, int32 InDepth = 1)
+			: Width(InWidth)
+			, Height(InHeight)
+			, Depth(InDepth)
+			, WidthDivisor(InWidth)
+			, SliceDivisor(InWidth * InHeight)
+		{
+			check(InWidth > 0 && InHeight > 0 && InDepth > 0);
+			check(int64(InWidth) * InHeight * InDepth <= MAX_int32);
+		}
+
+		FORCEINLINE int32 GetWidth() const { return Width; }
+		FORCEINLINE int32 GetHeight() const { return Height; }
+		FORCEINLINE int32 GetDepth() const { return Depth; }
+		FORCEINLINE int32 GetSliceSize() const { return Width * Height; }
+		FORCEINLINE int32 Num() const { return Width * Height * Depth; }
+
+		FORCEINLINE int32 ToIndex(int32 X, int32 Y, int32 Z = 0) const
+		{
+			return (Z * Height + Y) * Width + X;
+		}
+
+		FORCEINLINE void ToCoords(int32 Index, int32& OutX, int32& OutY) const
+		{
+			WidthDivisor.DivMod(Index, OutY, OutX);
+		}
+
+		FORCEINLINE void ToCoords(int32 Index, int32& OutX, int32& OutY, int32& OutZ) const
+		{
+			int32 Remainder;
+			SliceDivisor.DivMod(Index, OutZ, Remainder);
+			WidthDivisor.DivMod(Remainder, OutY, OutX);
+		}
+
+		FORCEINLINE bool Contains(int32 X, int32 Y, int32 Z = 0) const
+		{
+			return uint32(X) < uint32(Width) && uint32(Y) < uint32(Height) && uint32(Z) < uint32(Depth);
+		}
+
+		// Index of the cell offset by (DX,DY,DZ) from Index, or INDEX_NONE past the grid edges
+		FORCEINLINE int32 GetNeighbor(int32 Index, int32 DX, int32 DY, int32 DZ = 0) const
+		{
+			int32 X, Y, Z;
+			ToCoords(Index, X, Y, Z);
+			return Contains(X + DX, Y + DY, Z + DZ) ? Index + ToIndex(DX, DY, DZ) : INDEX_NONE;
+		}
+
+	private:
+		int32 Width = 1;
+		int32 Height = 1;
+		int32 Depth = 1;
+		FGridDivisor WidthDivisor;
+		FGridDivisor SliceDivisor;
+	};
+}
@@ -4,15 +4,75 @@
 
 #include "IntrusiveRefCounter.h"
 #include "IntrusiveRefProvider.h"
+#include "Containers/EpochDomain.h"
+#include <atomic>
 
 namespace blk
 {
+    /** How the strong count is updated. */
+    enum class ERefCountThreading : uint8
+    {
+        // Plain int32, for objects that never leave their thread
+        NotThreadSafe,
+        // Relaxed AddRef, acquire-release Release. Enough to keep the count right and to make every
+        // write made under a reference visible to whoever drops the last one.
+        Relaxed,
+        // Sequentially consistent, needed when the count is paired with other atomics such as the
+        // provider slot
+        SequentiallyConsistent
+    };
+
+    /** Which AddRef/Release hooks are called on the derived class. */
+    enum class ERefCountHooks : uint8
+    {
+        // No hooks, the count is all there is
+        None,
+        // OnFirstRef and OnLastRelease on the 0 <-> 1 transitions
+        OnFirstRef,
+        // OnRefIncrement on every AddRef, plus the transition hooks
+        OnEveryRef
+    };
+
+    /** Whether the object carries the slot TIntrusiveRefProvider upgrades through. */
+    enum class ERefCountWeakRefs : uint8
+    {
+        // No slot, for objects reached through a side table such as TIntrusiveRefTable. Keeps
+        // the object down to its count.
+        None,
+        // One atomic pointer per object
+        ProviderSlot
+    };
+
+    /** Storage for the provider slot, empty without one so it takes no space as a base. */
+    template <typename Derived, bool bProviderSlot>
+    class TIntrusiveRefProviderSlot
+    {
+    protected:
+        friend struct TIntrusiveRefProvider<Derived>;
+        TAtomic<Derived*> ProviderSlot{ nullptr };
+
+        FORCEINLINE void StoreProviderSlot(Derived* Ptr) { ProviderSlot.Store(Ptr); }
+    };
+
+    template <typename Derived>
+    class TIntrusiveRefProviderSlot<Derived, false>
+    {
+    protected:
+        FORCEINLINE void StoreProviderSlot(Derived*) {}
+    };
+
     /**
-     CRTP base for intrusive AddRef/Release with a single weak provider slot.
-     Derived classes can hook OnRefIncrement() without virtual dispatch.
+     CRTP base for intrusive AddRef/Release with an optional weak provider slot.
+     Derived classes can hook OnRefIncrement(), OnFirstRef() and OnLastRelease() without
+     virtual dispatch, Hooks selects which of them are called.
      */
-    template <typename Derived>
-    class TIntrusiveRefCountable
+    template <
+        typename Derived,
+        ERefCountThreading Threading = ERefCountThreading::SequentiallyConsistent,
+        ERefCountHooks Hooks = ERefCountHooks::OnEveryRef,
+        ERefCountWeakRefs WeakRefs = ERefCountWeakRefs::ProviderSlot>
+    class TIntrusiveRefCountable :
+        public TIntrusiveRefProviderSlot<Derived, WeakRefs == ERefCountWeakRefs::ProviderSlot>
     {
     protected:
         // Prevent copy/move construction; only assignment to reinitialize in-place.
@@ -20,22 +80,108 @@ namespace blk
         TIntrusiveRefCountable(TIntrusiveRefCountable&&) = delete;
 
     public:
+        static constexpr bool bThreadSafeRefCount = Threading != ERefCountThreading::NotThreadSafe;
+
         FORCEINLINE TIntrusiveRefCountable() = default;
         FORCEINLINE ~TIntrusiveRefCountable() { Reset(); }
 
-        /** Increment strong reference count and call hook. */
+        /** Increment strong reference count and call hooks. */
         FORCEINLINE void AddRef()
         {
-            RefCount.IncrementExchange();
-            // Hook for derived classes (e.g. LRU tail move)
-            static_cast<Derived*>(this)->OnRefIncrement();
+            int32 Prev;
+            if constexpr (Threading == ERefCountThreading::NotThreadSafe) Prev = RefCount++;
+            else if constexpr (Threading == ERefCountThreading::Relaxed) Prev = RefCount.fetch_add(1, std::memory_order_relaxed);
+            else Prev = RefCount.fetch_add(1, std::memory_order_seq_cst);
+
+            CallAddRefHooks(Prev);
         }
 
+        /**
+         Weak-to-strong upgrade: AddRef unless the object has been retired. Lock-free, a zero
+         count is a live object that is merely unreferenced, so only the retired flag stops it.
+         */
+        FORCEINLINE bool TryAddRef()
+        {
+            int32 Prev;
+            if constexpr (Threading == ERefCountThreading::NotThreadSafe)
+            {
+                if (RefCount & RetiredFlag) return false;
+                Prev = RefCount++;
+            }
+            else
+            {
+                constexpr std::memory_order Order = Threading == ERefCountThreading::Relaxed
+                    ? std::memory_order_acquire : std::memory_order_seq_cst;
+
+                Prev = RefCount.load(std::memory_order_relaxed);
+                do
+                {
+                    if (Prev & RetiredFlag) return false;
+                }
+                while (!RefCount.compare_exchange_weak(Prev, Prev + 1, Order, std::memory_order_relaxed));
+            }
+
+            CallAddRefHooks(Prev);
+            return true;
+        }
+
+        /**
+         Marks an unreferenced object as dead: TryAddRef fails from here on and the provider slot
+         is cleared. Fails if a reference got in first. Reset brings the object back for reuse,
+         which must wait until no provider can still be upgrading (see FEpochDomain).
+         */
+        FORCEINLINE bool TryRetire()
+        {
+            if constexpr (Threading == ERefCountThreading::NotThreadSafe)
+            {
+                if (RefCount != 0) return false;
+                RefCount = RetiredFlag;
+            }
+            else
+            {
+                int32 Expected = 0;
+                if (!RefCount.compare_exchange_strong(Expected, RetiredFlag, std::memory_order_seq_cst)) return false;
+            }
+
+            this->StoreProviderSlot(nullptr);
+            return true;
+        }
+
+        FORCEINLINE bool IsRetired() const { return (LoadRefCount() & RetiredFlag) != 0; }
+
         /** Decrement strong reference count. Asserts on underflow. Returns new count. */
         FORCEINLINE int32 Release()
         {
-            int32 Prev = RefCount.DecrementExchange();
+            constexpr std::memory_order Order = Threading == ERefCountThreading::Relaxed
+                ? std::memory_order_acq_rel : std::memory_order_seq_cst;
+
+            int32 Prev;
+            if constexpr (Threading == ERefCountThreading::NotThreadSafe) Prev = RefCount--;
+            else if constexpr (Hooks != ERefCountHooks::None)
+            {
+                // Drops that can't reach zero go through without a guard
+                Prev = RefCount.load(std::memory_order_relaxed);
+                while (Prev > 1 && !RefCount.compare_exchange_weak(Prev, Prev - 1, Order, std::memory_order_relaxed)) {}
+
+                if (Prev <= 1)
+                {
+                    // Once the count is zero the owner may retire the object and free its storage,
+                    // pinned so that waits until OnLastRelease is done with it
+                    FEpochDomain::FGuard Guard;
+                    Prev = RefCount.fetch_sub(1, Order);
+
+                    checkf(Prev > 0, TEXT("TIntrusiveRefCountable Double Release()"));
+                    if (Prev == 1) static_cast<Derived*>(this)->OnLastRelease();
+                    return Prev - 1;
+                }
+            }
+            else Prev = RefCount.fetch_sub(1, Order);
+
             checkf(Prev > 0, TEXT("TIntrusiveRefCountable Double Release()"));
+            if constexpr (Hooks != ERefCountHooks::None)
+            {
+                if (Prev == 1) static_cast<Derived*>(this)->OnLastRelease();
+            }
             return Prev - 1;
         }
 
@@ -46,26 +192,48 @@ namespace blk
                 TEXT("TIntrusiveRefCountable::Reset() called with non-zero refcount"));
 
             // Invalidate old weak provider
-            ProviderSlot.Store(nullptr);
+            this->StoreProviderSlot(nullptr);
 
-            // Clear strong count again (in case it's reused)
-            RefCount.Store(0);
+            // Clear strong count and the retired flag (in case it's reused)
+            if constexpr (Threading == ERefCountThreading::NotThreadSafe) RefCount = 0;
+            else RefCount.store(0, std::memory_order_relaxed);
         }
 
         /** Get current strong ref count. */
-        FORCEINLINE int32 GetRefCount() const { return RefCount.Load(); }
+        FORCEINLINE int32 GetRefCount() const { return LoadRefCount() & ~RetiredFlag; }
 
         /** Default hook called after AddRef; no-op unless overridden. */
         void OnRefIncrement() {}
 
-    protected:
-        // Single slot storing a pointer to this object for weak providers
-        friend struct TIntrusiveRefProvider<Derived>;
-        TAtomic<Derived*> ProviderSlot{ nullptr };
+        /** Default hook called after the count goes from 0 to 1; no-op unless overridden. */
+        void OnFirstRef() {}
+
+        /** Default hook called after the count goes from 1 to 0; no-op unless overridden. */
+        void OnLastRelease() {}
 
     private:
-        // Atomic strong reference count
-        TAtomic<int32> RefCount{ 0 };
+        // Set in the count once retired, so TryAddRef can test liveness and count in one CAS
+        static constexpr int32 RetiredFlag = MIN_int32;
+
+        FORCEINLINE int32 LoadRefCount() const
+        {
+            if constexpr (Threading == ERefCountThreading::NotThreadSafe) return RefCount;
+            else if constexpr (Threading == ERefCountThreading::Relaxed) return RefCount.load(std::memory_order_acquire);
+            else return RefCount.load(std::memory_order_seq_cst);
+        }
+
+        FORCEINLINE void CallAddRefHooks(int32 Prev)
+        {
+            // Hooks for derived classes (e.g. LRU tail move)
+            if constexpr (Hooks == ERefCountHooks::OnEveryRef) static_cast<Derived*>(this)->OnRefIncrement();
+            if constexpr (Hooks != ERefCountHooks::None)
+            {
+                if (Prev == 0) static_cast<Derived*>(this)->OnFirstRef();
+            }
+        }
+
+        // Strong reference count, atomic unless NotThreadSafe
+        std::conditional_t<Threading == ERefCountThreading::NotThreadSafe, int32, std::atomic<int32>> RefCount{ 0 };
 
     };
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "IntrusiveRefCounter.h"
+#include "Containers/EpochDomain.h"
 
 namespace blk
 {/**
@@ -10,6 +11,8 @@ namespace blk
      * Allows reviving a strong reference if the object is still alive in the container.
      * If a TIntrusiveRefProvider exists, the original object must outlive it, or it
      * must be destroyed when the original object is freed.
+     * Owners that recycle objects concurrently with Acquire retire them with TryRetire and
+     * only Reset them once FEpochDomain::Get() says no upgrade can still be in flight.
      */
     template <typename T>
     struct TIntrusiveRefProvider
@@ -28,6 +31,27 @@ namespace blk
                 return nullptr;
             }
 
+            if constexpr (T::bThreadSafeRefCount)
+            {
+                // Pinned, so a retired object can not be reset and reused under the upgrade
+                FEpochDomain::FGuard Guard;
+                return Upgrade();
+            }
+            else
+            {
+                return Upgrade();
+            }
+        }
+
+        /** True if the object slot is non-null (may still have been destroyed). */
+        FORCEINLINE bool IsValid() const
+        {
+            return Slot && Slot->Load() != nullptr;
+        }
+
+    private:
+        FORCEINLINE TIntrusiveRefCounter<T> Upgrade() const
+        {
             // 1) Load the stored pointer
             T* Ptr = Slot->Load();
             if (!Ptr)
@@ -35,10 +59,13 @@ namespace blk
                 return nullptr;
             }
 
-            // 2) Bump strong count (calls OnRefIncrement hook)
-            Ptr->AddRef();
+            // 2) Bump strong count unless retired (calls OnRefIncrement hook)
+            if (!Ptr->TryAddRef())
+            {
+                return nullptr;
+            }
 
-            // 3) Re-check slot to avoid race with destruction
+            // 3) Re-check slot for owners that Reset without retiring
             if (Slot->Load() != Ptr)
             {
                 Ptr->Release();
@@ -48,13 +75,6 @@ namespace blk
             return TIntrusiveRefCounter<T>(Ptr, ENoAddRef{});
         }
 
-        /** True if the object slot is non-null (may still have been destroyed). */
-        FORCEINLINE bool IsValid() const
-        {
-            return Slot && Slot->Load() != nullptr;
-        }
-
-    private:
         // Pointer to the object's ProviderSlot
         TAtomic<T*>* Slot = nullptr;
     };
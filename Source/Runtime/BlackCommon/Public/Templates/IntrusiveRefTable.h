@@ -0,0 +1,148 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IntrusiveRefCounter.h"
+#include "Containers/EpochDomain.h"
+#include "Containers/SlotMap.h"
+#include <atomic>
+
+namespace blk
+{
+	// Side table behind 8 byte weak handles to TIntrusiveRefCountable objects. Unlike
+	// TIntrusiveRefProvider, a handle holds an index and a generation instead of a pointer into
+	// the object, so the owner may free the object's storage once it is retired and its grace
+	// period is over. Removing an index bumps its generation, which turns every handle to it
+	// stale with a single compare.
+	//
+	// Add and Remove are called under the owner's lock, Acquire and IsValid from any thread.
+	// Entries live in segments of doubling size that are never moved, so readers need no lock.
+	template <typename T>
+	class TIntrusiveRefTable
+	{
+	public:
+		TIntrusiveRefTable() = default;
+
+		~TIntrusiveRefTable()
+		{
+			for (std::atomic<FEntry*>& Segment : Segments)
+			{
+				delete[] Segment.load(std::memory_order_relaxed);
+			}
+		}
+
+		TIntrusiveRefTable(const TIntrusiveRefTable&) = delete;
+		TIntrusiveRefTable& operator=(const TIntrusiveRefTable&) = delete;
+
+		// Points Index at Object and returns a handle to it. Index must not be in use.
+		FSlotHandle Add(uint32 Index, T* Object)
+		{
+			FEntry& Entry = GetOrAddEntry(Index);
+			check(Entry.Object.load(std::memory_order_relaxed) == nullptr);
+
+			uint32 Generation = Entry.Generation.load(std::memory_order_relaxed);
+			if (Generation == 0)
+			{
+				Generation = 1;
+				Entry.Generation.store(Generation, std::memory_order_relaxed);
+			}
+
+			Entry.Object.store(Object, std::memory_order_release);
+			return FSlotHandle{ Index, Generation };
+		}
+
+		// Turns every handle to Index stale. Call once the object has been retired, its storage
+		// may go after a grace period of FEpochDomain::Get().
+		void Remove(uint32 Index)
+		{
+			FEntry* Entry = FindEntry(Index);
+			check(Entry);
+
+			uint32 Generation = Entry->Generation.load(std::memory_order_relaxed) + 1;
+			if (Generation == 0) Generation = 1;
+
+			Entry->Generation.store(Generation, std::memory_order_release);
+			Entry->Object.store(nullptr, std::memory_order_release);
+		}
+
+		// Strong ref to the object behind Handle, null if the handle is stale or the object has
+		// been retired
+		TIntrusiveRefCounter<T> Acquire(FSlotHandle Handle) const
+		{
+			if (Handle.IsNull()) return nullptr;
+
+			// Pinned, so a retired object can not be reset or freed under the upgrade
+			FEpochDomain::FGuard Guard;
+
+			const FEntry* Entry = FindEntry(Handle.Index);
+			if (!Entry || Entry->Generation.load(std::memory_order_acquire) != Handle.Generation) return nullptr;
+
+			// A new object only takes the index after a grace period, so a successful upgrade is
+			// on the object the generation was read for
+			T* Object = Entry->Object.load(std::memory_order_acquire);
+			if (!Object || !Object->TryAddRef()) return nullptr;
+
+			return TIntrusiveRefCounter<T>(Object, ENoAddRef{});
+		}
+
+		// True if the handle is current. The object may still be retired right after.
+		bool IsValid(FSlotHandle Handle) const
+		{
+			if (Handle.IsNull()) return false;
+
+			const FEntry* Entry = FindEntry(Handle.Index);
+			return Entry && Entry->Generation.load(std::memory_order_acquire) == Handle.Generation
+				&& Entry->Object.load(std::memory_order_relaxed) != nullptr;
+		}
+
+	private:
+		static constexpr uint32 FirstSegmentSize = 64;
+		static constexpr int32 SegmentCount = 27; // Covers every uint32 index
+
+		struct FEntry
+		{
+			std::atomic<uint32> Generation{ 0 };
+			std::atomic<T*> Object{ nullptr };
+		};
+
+		// Segment K holds FirstSegmentSize << K entries
+		static FORCEINLINE void Locate(uint32 Index, int32& OutSegment, uint32& OutOffset)
+		{
+			OutSegment = int32(FMath::FloorLog2(Index / FirstSegmentSize + 1));
+			OutOffset = Index - FirstSegmentSize * ((1u << OutSegment) - 1);
+		}
+
+		FORCEINLINE const FEntry* FindEntry(uint32 Index) const
+		{
+			int32 Segment;
+			uint32 Offset;
+			Locate(Index, Segment, Offset);
+
+			const FEntry* Entries = Segments[Segment].load(std::memory_order_acquire);
+			return Entries ? &Entries[Offset] : nullptr;
+		}
+
+		FORCEINLINE FEntry* FindEntry(uint32 Index)
+		{
+			return const_cast<FEntry*>(static_cast<const TIntrusiveRefTable*>(this)->FindEntry(Index));
+		}
+
+		FEntry& GetOrAddEntry(uint32 Index)
+		{
+			int32 Segment;
+			uint32 Offset;
+			Locate(Index, Segment, Offset);
+
+			FEntry* Entries = Segments[Segment].load(std::memory_order_relaxed);
+			if (!Entries)
+			{
+				Entries = new FEntry[SIZE_T(FirstSegmentSize) << Segment];
+				Segments[Segment].store(Entries, std::memory_order_release);
+			}
+			return Entries[Offset];
+		}
+
+		std::atomic<FEntry*> Segments[SegmentCount] = {};
+	};
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+namespace blk
+{
+	// Default reset hook, calls Reset() on objects that have one. TArray::Reset and friends keep
+	// their allocation, so pooled containers come back empty but without a trip to the heap.
+	template <typename T>
+	struct TPooledObjectReset
+	{
+		FORCEINLINE void operator()(T& Object) const
+		{
+			if constexpr (requires { Object.Reset(); }) Object.Reset();
+		}
+	};
+
+	// Reset hook that leaves objects as they were released
+	template <typename T>
+	struct TNoPooledObjectReset
+	{
+		FORCEINLINE void operator()(T&) const {}
+	};
+
+	// Move only handle to an object owned by a pool. The object is reset with TReset and handed
+	// back to the pool when the handle dies, so early returns cannot leak it. The pool must
+	// outlive its handles. TPool needs a Release(T*), it is usually still incomplete where the
+	// handle type is named, so this is not a constraint.
+	template <typename T, typename TPool, typename TReset = TPooledObjectReset<T>>
+	class TPooledPtr
+	{
+	public:
+		FORCEINLINE TPooledPtr() = default;
+
+		FORCEINLINE TPooledPtr(T* InPtr, TPool& InPool)
+			: Ptr(InPtr)
+			, Pool(&InPool)
+		{
+		}
+
+		TPooledPtr(const TPooledPtr&) = delete;
+		TPooledPtr& operator=(const TPooledPtr&) = delete;
+
+		FORCEINLINE TPooledPtr(TPooledPtr&& Other) noexcept
+			: Ptr(Other.Ptr)
+			, Pool(Other.Pool)
+		{
+			Other.Ptr = nullptr;
+		}
+
+		FORCEINLINE TPooledPtr& operator=(TPooledPtr&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				Reset();
+				Ptr = Other.Ptr;
+				Pool = Other.Pool;
+				Other.Ptr = nullptr;
+			}
+			return *this;
+		}
+
+		FORCEINLINE ~TPooledPtr()
+		{
+			Reset();
+		}
+
+		// Returns the object to its pool now
+		FORCEINLINE void Reset()
+		{
+			if (!Ptr) return;
+
+			TReset()(*Ptr);
+			Pool->Release(Ptr);
+			Ptr = nullptr;
+		}
+
+		FORCEINLINE T* Get() const { return Ptr; }
+		FORCEINLINE T& operator*() const { return *Ptr; }
+		FORCEINLINE T* operator->() const { return Ptr; }
+		FORCEINLINE explicit operator bool() const { return Ptr != nullptr; }
+		FORCEINLINE bool IsValid() const { return Ptr != nullptr; }
+
+	private:
+		T* Ptr = nullptr;
+		TPool* Pool = nullptr;
+	};
+}
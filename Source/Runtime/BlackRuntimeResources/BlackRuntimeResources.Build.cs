@@ -15,7 +15,9 @@ public class BlackRuntimeResources : ModuleRules
         });
 
 		PrivateDependencyModuleNames.AddRange(new string[] {
-            "BlackCommon"
+            "BlackCommon",
+            "RenderCore",
+            "RHI"
         });
 	}
 }
@@ -0,0 +1,237 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "BlockCompression.h"
+
+namespace BlockCompression
+{
+	namespace
+	{
+		// Byte offset of the red channel, and of green and blue for BC1
+		struct FChannelLayout
+		{
+			int32 BytesPerPixel = 0;
+			int32 R = 0;
+			int32 G = 0;
+			int32 B = 0;
+		};
+
+		bool GetLayout(EPixelFormat Format, FChannelLayout& OutLayout)
+		{
+			switch (Format)
+			{
+			case PF_B8G8R8A8: OutLayout = { 4, 2, 1, 0 }; return true;
+			case PF_R8G8B8A8: OutLayout = { 4, 0, 1, 2 }; return true;
+			case PF_G8:
+			case PF_R8:
+			case PF_A8:
+			case PF_L8:       OutLayout = { 1, 0, 0, 0 }; return true;
+			default:          return false;
+			}
+		}
+
+		FORCEINLINE uint16 To565(int32 R, int32 G, int32 B)
+		{
+			return uint16(((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3));
+		}
+
+		FORCEINLINE void From565(uint16 Color, int32* Out)
+		{
+			const int32 R = (Color >> 11) & 31;
+			const int32 G = (Color >> 5) & 63;
+			const int32 B = Color & 31;
+			Out[0] = (R << 3) | (R >> 2);
+			Out[1] = (G << 2) | (G >> 4);
+			Out[2] = (B << 3) | (B >> 2);
+		}
+
+		// Bounding box endpoints inset by 1/16 of the range, then nearest of the four palette
+		// colors per pixel. Always opaque four color mode.
+		void EncodeBC1Block(const uint8* Source, int32 SourcePitch, const FChannelLayout& Layout, uint8* Dest)
+		{
+			int32 Pixels[16][3];
+			int32 Min[3] = { 255, 255, 255 };
+			int32 Max[3] = { 0, 0, 0 };
+
+			for (int32 y = 0; y < 4; ++y)
+			{
+				const uint8* Row = Source + y * SourcePitch;
+				for (int32 x = 0; x < 4; ++x)
+				{
+					const uint8* Pixel = Row + x * Layout.BytesPerPixel;
+					int32* Out = Pixels[y * 4 + x];
+					Out[0] = Pixel[Layout.R];
+					Out[1] = Pixel[Layout.G];
+					Out[2] = Pixel[Layout.B];
+
+					for (int32 c = 0; c < 3; ++c)
+					{
+						Min[c] = FMath::Min(Min[c], Out[c]);
+						Max[c] = FMath::Max(Max[c], Out[c]);
+					}
+				}
+			}
+
+			// Picks the box diagonal that follows red and green against blue
+			int32 CovarianceR = 0;
+			int32 CovarianceG = 0;
+			for (int32 i = 0; i < 16; ++i)
+			{
+				const int32 B = Pixels[i][2] * 2 - (Min[2] + Max[2]);
+				CovarianceR += (Pixels[i][0] * 2 - (Min[0] + Max[0])) * B;
+				CovarianceG += (Pixels[i][1] * 2 - (Min[1] + Max[1])) * B;
+			}
+			if (CovarianceR < 0) Swap(Min[0], Max[0]);
+			if (CovarianceG < 0) Swap(Min[1], Max[1]);
+
+			for (int32 c = 0; c < 3; ++c)
+			{
+				const int32 Inset = (Max[c] - Min[c]) >> 4;
+				Min[c] += Inset;
+				Max[c] -= Inset;
+			}
+
+			uint16 Color0 = To565(Max[0], Max[1], Max[2]);
+			uint16 Color1 = To565(Min[0], Min[1], Min[2]);
+			if (Color0 < Color1) Swap(Color0, Color1);
+
+			int32 Palette[4][3];
+			From565(Color0, Palette[0]);
+			From565(Color1, Palette[1]);
+			for (int32 c = 0; c < 3; ++c)
+			{
+				Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+				Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+			}
+
+			// Equal endpoints select three color mode, where index 0 still decodes to Color0
+			uint32 Indices = 0;
+			if (Color0 != Color1)
+			{
+				for (int32 i = 0; i < 16; ++i)
+				{
+					int32 Best = 0;
+					int32 BestDistance = MAX_int32;
+					for (int32 p = 0; p < 4; ++p)
+					{
+						const int32 DR = Pixels[i][0] - Palette[p][0];
+						const int32 DG = Pixels[i][1] - Palette[p][1];
+						const int32 DB = Pixels[i][2] - Palette[p][2];
+						const int32 Distance = DR * DR + DG * DG + DB * DB;
+						if (Distance < BestDistance)
+						{
+							Best = p;
+							BestDistance = Distance;
+						}
+					}
+					Indices |= uint32(Best) << (i * 2);
+				}
+			}
+
+			Dest[0] = uint8(Color0);
+			Dest[1] = uint8(Color0 >> 8);
+			Dest[2] = uint8(Color1);
+			Dest[3] = uint8(Color1 >> 8);
+			FMemory::Memcpy(Dest + 4, &Indices, 4);
+		}
+
+		// Min and max endpoints in eight value mode, nearest palette value per pixel
+		void EncodeBC4Block(const uint8* Source, int32 SourcePitch, const FChannelLayout& Layout, uint8* Dest)
+		{
+			int32 Values[16];
+			int32 Min = 255;
+			int32 Max = 0;
+
+			for (int32 y = 0; y < 4; ++y)
+			{
+				const uint8* Row = Source + y * SourcePitch;
+				for (int32 x = 0; x < 4; ++x)
+				{
+					const int32 Value = Row[x * Layout.BytesPerPixel + Layout.R];
+					Values[y * 4 + x] = Value;
+					Min = FMath::Min(Min, Value);
+					Max = FMath::Max(Max, Value);
+				}
+			}
+
+			int32 Palette[8];
+			Palette[0] = Max;
+			Palette[1] = Min;
+			for (int32 p = 2; p < 8; ++p)
+			{
+				Palette[p] = ((8 - p) * Max + (p - 1) * Min) / 7;
+			}
+
+			uint64 Indices = 0;
+			if (Max != Min)
+			{
+				for (int32 i = 0; i < 16; ++i)
+				{
+					int32 Best = 0;
+					int32 BestDistance = MAX_int32;
+					for (int32 p = 0; p < 8; ++p)
+					{
+						const int32 Distance = FMath::Abs(Values[i] - Palette[p]);
+						if (Distance < BestDistance)
+						{
+							Best = p;
+							BestDistance = Distance;
+						}
+					}
+					Indices |= uint64(Best) << (i * 3);
+				}
+			}
+
+			Dest[0] = uint8(Max);
+			Dest[1] = uint8(Min);
+			for (int32 b = 0; b < 6; ++b)
+			{
+				Dest[2 + b] = uint8(Indices >> (b * 8));
+			}
+		}
+	}
+
+	EPixelFormat GetCompressedFormat(ETextureAtlasCompression Compression, EPixelFormat Source)
+	{
+		FChannelLayout Layout;
+		if (!GetLayout(Source, Layout)) return PF_Unknown;
+
+		switch (Compression)
+		{
+		case ETextureAtlasCompression::BC1: return Layout.BytesPerPixel == 4 ? PF_DXT1 : PF_Unknown;
+		case ETextureAtlasCompression::BC4: return PF_BC4;
+		default:                            return PF_Unknown;
+		}
+	}
+
+	void Encode(
+		ETextureAtlasCompression Compression, EPixelFormat SourceFormat,
+		const uint8* Source, int32 SourcePitch,
+		uint8* Dest,
+		int32 Width, int32 Height)
+	{
+		check(Width % 4 == 0 && Height % 4 == 0);
+
+		FChannelLayout Layout;
+		verify(GetLayout(SourceFormat, Layout));
+
+		// Both formats use 8 byte blocks
+		constexpr int32 BlockBytes = 8;
+
+		for (int32 y = 0; y < Height; y += 4)
+		{
+			for (int32 x = 0; x < Width; x += 4)
+			{
+				const uint8* Block = Source + y * SourcePitch + x * Layout.BytesPerPixel;
+				if (Compression == ETextureAtlasCompression::BC1)
+				{
+					EncodeBC1Block(Block, SourcePitch, Layout, Dest);
+				}
+				else
+				{
+					EncodeBC4Block(Block, SourcePitch, Layout, Dest);
+				}
+				Dest += BlockBytes;
+			}
+		}
+	}
+}
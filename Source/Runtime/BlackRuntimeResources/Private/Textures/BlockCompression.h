@@ -0,0 +1,20 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Textures/TextureAtlasBase.h"
+
+namespace BlockCompression
+{
+	// Texture format the atlas is stored in, or PF_Unknown if Source can not be encoded to it
+	EPixelFormat GetCompressedFormat(ETextureAtlasCompression Compression, EPixelFormat Source);
+
+	// Encodes a Width x Height region (both multiples of 4) into rows of 4x4 blocks. Dest rows
+	// are (Width / 4) blocks apart.
+	void Encode(
+		ETextureAtlasCompression Compression, EPixelFormat SourceFormat,
+		const uint8* Source, int32 SourcePitch,
+		uint8* Dest,
+		int32 Width, int32 Height);
+}
@@ -3,39 +3,6 @@
 #include "Textures/LRUTextureAtlas.h"
 #include "Math/ArrayIndexing.h"
 
-void FLRUTextureAtlasIndex::Init(
-	ULRUTextureAtlas* atlas,
-	int32 InNodeIndex
-)
-{
-	Freed = true;
-	Atlas = atlas;
-	NodeIndex = InNodeIndex;
-}
-
-void FLRUTextureAtlasIndex::Reinit(FIntPoint InValue)
-{
-	check(Freed);
-	Freed = false;
-	ProviderSlot.Store(this);
-	Value = InValue;
-}
-
-void FLRUTextureAtlasIndex::Free()
-{
-	check(!Freed);
-	check(!this->IsInList());
-	Freed = true;
-	blk::TIntrusiveRefCountable<FLRUTextureAtlasIndex>::Reset();
-	ProviderSlot.Store(nullptr);
-}
-
-// Moves the node back to tail on new access
-void FLRUTextureAtlasIndex::OnRefIncrement() 
-{ 
-	if (Atlas) Atlas->MoveToTail(this); 
-}
-
 void ULRUTextureAtlas::Initialize(
 	int32 InAtlasWidth, int32 InAtlasHeight,
 	int32 InTileWidth, int32 InTileHeight,
@@ -48,44 +15,66 @@ void ULRUTextureAtlas::Initialize(
 		InTilePadding, InFormat
 	);
 
-	TileIndexPool.SetWidth(InTileWidth);
+	TileIndexPool.SetMortonExtent(GetMaxTileIndexX() + 1, GetMaxTileIndexY() + 1);
+
+	// A node is queued at most once until drained, so one atlas worth of cells never overflows
+	Nodes.Init(
+		LRUMutex,
+		bDeferTouches ? GetMaxTileCount() : 0,
+		[this](const FIntPoint& TileIndex, bool bReferenced) { OnTileTouched(TileIndex, bReferenced); });
 }
 
-TArray<ULRUTextureAtlas::IndexProvider> ULRUTextureAtlas::GetUnusedTiles(int32 Count)
+void ULRUTextureAtlas::BeginDestroy()
 {
-	TArray<IndexProvider> OutProviders;
-	OutProviders.Reserve(Count);
+	QueuedUploads.Empty();
+	Super::BeginDestroy();
+}
 
-	// No more new tiles in the atlas, so we need to evict unused tiles
-	if (TileCount + Count >= GetMaxTileCount()) Evict(Count);
+TArray<ULRUTextureAtlas::IndexHandle> ULRUTextureAtlas::GetUnusedTiles(int32 Count)
+{
+	TArray<IndexHandle> OutHandles;
+	AddUnusedTiles(Count, OutHandles);
+	return OutHandles;
+}
 
-	for (int i = 0; i < Count; ++i)
-	{
-		int32 nodeIndex = NodeIndexPool.Acquire();
+bool ULRUTextureAtlas::GetUnusedTiles(int32 Count, TArray<IndexHandle, blk::FFrameAllocator>& OutHandles)
+{
+	return AddUnusedTiles(Count, OutHandles);
+}
 
-		// Default constructs new unconstructed Index if needed, and initializes
-		if (Nodes.Num() == nodeIndex) 
-		{
-			Nodes.Add(1);
-			Nodes[nodeIndex].Init(this, nodeIndex);
-		}
+template <typename AllocatorType>
+bool ULRUTextureAtlas::AddUnusedTiles(int32 Count, TArray<IndexHandle, AllocatorType>& OutHandles)
+{
+	// Held across the capacity check, so concurrent callers can't both count on the same room.
+	// GrowCapacity and Evict lock again, FCriticalSection is recursive.
+	FScopeLock Lock(&LRUMutex);
 
-		// Sets new value for a freed Index
-		Nodes[nodeIndex].Reinit(TileIndexPool.Acquire());
+	// Derived atlases may add room before we fall back to eviction
+	GrowCapacity(Nodes.Num() + Count);
 
-		// Gets a pointer to the new Index in the ChunkedArray
-		Index* Ptr = &Nodes[nodeIndex];
+	// No more new tiles in the atlas, so we need to evict unused tiles
+	const int32 Overflow = Nodes.Num() + Count - GetTileCapacity();
+	if (Overflow > 0 && !Evict(Overflow))
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("ULRUTextureAtlas::GetUnusedTiles failed: not enough unreferenced tiles for %d new tiles."),
+			Count);
+		return false;
+	}
 
-		// Adds it to the tail (most recently used) of the lru cache
-		LRU.AddTail(Ptr);
+	OutHandles.Reserve(OutHandles.Num() + Count);
 
-		// Adds a provider to the output TArray
-		OutProviders.Emplace(Ptr);
+	// Evicted nodes come back once no handle can still be upgrading them
+	Nodes.ReclaimLocked();
 
-		++TileCount;
+	for (int i = 0; i < Count; ++i)
+	{
+		OutHandles.Add(Nodes.AddLocked(AcquireTileIndex()));
 	}
 
-	return OutProviders;
+	return true;
 }
 
 void ULRUTextureAtlas::WriteTiles(
@@ -93,7 +82,8 @@ void ULRUTextureAtlas::WriteTiles(
 	TArray<uint8>& PixelData
 )
 {
-	TArray<FIntPoint> DestIndices;
+	blk::FFrameArenaMark Mark;
+	TArray<FIntPoint, blk::FFrameAllocator> DestIndices;
 	DestIndices.Reserve(TileIndices.Num());
 
 	for (int i = 0; i < TileIndices.Num(); ++i)
@@ -105,75 +95,193 @@ void ULRUTextureAtlas::WriteTiles(
 	WriteTiles(DestIndices, PixelData);
 }
 
-TArray<ULRUTextureAtlas::IndexProvider> ULRUTextureAtlas::WriteTiles(
+TArray<ULRUTextureAtlas::IndexHandle> ULRUTextureAtlas::WriteTiles(
 	TArray<uint8>& PixelData,
 	int32 Count
 )
 {
 	// Reserves n coordinates
-	TArray<IndexProvider> Providers = GetUnusedTiles(Count);
+	TArray<IndexHandle> NewHandles = GetUnusedTiles(Count);
+	if (NewHandles.Num() != Count) return NewHandles;
 
-	TArray<FIntPoint> DestIndices;
+	blk::FFrameArenaMark Mark;
+	TArray<FIntPoint, blk::FFrameAllocator> DestIndices;
 	DestIndices.Reserve(Count);
 
 	// Creates a shared pointer to the coordinate, and adds that to the dstCoords
-	for (int i = 0; i < Providers.Num(); ++i)
+	for (int i = 0; i < NewHandles.Num(); ++i)
 	{
-		check(Providers[i].IsValid());
-		auto ptr = Providers[i].Acquire();
+		auto ptr = Acquire(NewHandles[i]);
 		check(ptr);
 		DestIndices.Add(*ptr);
 	}
 
 	WriteTiles(DestIndices, PixelData);
-	return Providers;
+	return NewHandles;
 }
 
-void ULRUTextureAtlas::Evict(int32 Count)
+void ULRUTextureAtlas::QueueTileUpload(
+	TArray<IndexCounter>&& Tiles,
+	TArray<uint8>&& PixelData
+)
+{
+	TArray<FIntPoint> TileIndices;
+	TileIndices.Reserve(Tiles.Num());
+	for (const IndexCounter& Tile : Tiles)
+	{
+		check(Tile);
+		TileIndices.Add(*Tile);
+	}
+
+	// Released on whichever thread flushes, dropping the last ref just relinks the tile
+	Super::QueueTileUpload(
+		MoveTemp(TileIndices),
+		MoveTemp(PixelData),
+		MakeShared<TArray<IndexCounter>, ESPMode::ThreadSafe>(MoveTemp(Tiles)));
+}
+
+ULRUTextureAtlas::IndexCounter ULRUTextureAtlas::Find(uint64 Key)
 {
 	FScopeLock Lock(&LRUMutex);
-	int32 EvictedCount = 0;
+	return FindLocked(Key);
+}
 
-	// Head is the least recently used item. Items move to tail upon use. 
-	for (auto it = LRU.begin(); it != LRU.end();)
+ULRUTextureAtlas::IndexCounter ULRUTextureAtlas::FindLocked(uint64 Key)
+{
+	// Keys leave with their tile under the lock, so a mapped tile always upgrades here
+	const IndexHandle* Found = KeyedTiles.Find(Key);
+	return Found ? Acquire(*Found) : nullptr;
+}
+
+ULRUTextureAtlas::IndexCounter ULRUTextureAtlas::FindOrAdd(
+	uint64 Key,
+	TFunctionRef<void(TArray<uint8>& PixelData)> Producer
+)
+{
 	{
-		// Store reference to current iterator
-		Index& Index = *it;
+		FScopeLock Lock(&LRUMutex);
+		if (IndexCounter Found = FindLocked(Key))
+		{
+			++CacheStats.Hits;
+			return Found;
+		}
+	}
+
+	// New tiles are unreferenced until acquired, so eviction may take one back before that
+	IndexHandle Handle;
+	IndexCounter Tile;
+	while (!Tile)
+	{
+		blk::FFrameArenaMark Mark;
+		TArray<IndexHandle, blk::FFrameAllocator> NewHandles;
+		if (!GetUnusedTiles(1, NewHandles)) return nullptr;
 
-		// Pre-increment the iterator before doing anything destructive
-		++it;
+		Handle = NewHandles[0];
+		Tile = Acquire(Handle);
+	}
+
+	{
+		FScopeLock Lock(&LRUMutex);
 
-		// Finds unused nodes
-		if (Index.GetRefCount() == 0)
+		// Another thread added the key while we took a tile. Ours was never written, so it goes
+		// straight back once its touches are settled.
+		if (IndexCounter Found = FindLocked(Key))
 		{
-			// Notifies anyone that a coordinate will be released
-			OnEvict.Broadcast(Index);
-
-			// Releases the index
-			LRU.Remove(&Index);
-			Index.Free();
-			NodeIndexPool.Release(Index.GetNodeIndex());
-			TileIndexPool.Release(Index);
-
-			// Only needs 'count' evictions. 
-			++EvictedCount;
-			if (EvictedCount == Count) return;
+			++CacheStats.Hits;
+
+			const int32 NodeIndex = Tile->GetNodeIndex();
+			Tile = IndexCounter();
+			Nodes.FlushTouchesLocked();
+			EvictLocked(NodeIndex);
+			return Found;
 		}
+
+		// Keyed before production, so concurrent misses share this tile. Its pixels land with
+		// the upload queued below.
+		KeyedTiles.Add(Key, Handle);
+		NodeKeys.Add(Tile->GetNodeIndex(), Key);
+		++CacheStats.Misses;
 	}
 
-	// Not possible to evict more. Continuing will result in corrupted textures, so we hard crash.
-	UE_LOG(
-		LogTemp,
-		Fatal,
-		TEXT("ULRUTextureAtlas::Evict failed: only %zu of %zu entries evicted. "),
-		EvictedCount,
-		Count);
+	// Owned by the upload queue, which also keeps the tile until the upload is submitted
+	TArray<uint8> PixelData = AcquireUploadBuffer();
+	Producer(PixelData);
+
+	TArray<IndexCounter> Tiles;
+	Tiles.Add(Tile);
+	QueueTileUpload(MoveTemp(Tiles), MoveTemp(PixelData));
+
+	return Tile;
 }
 
+FLRUTextureAtlasCacheStats ULRUTextureAtlas::GetCacheStats() const
+{
+	FScopeLock Lock(&LRUMutex);
+	return CacheStats;
+}
+
+void ULRUTextureAtlas::ResetCacheStats()
+{
+	FScopeLock Lock(&LRUMutex);
+	CacheStats = FLRUTextureAtlasCacheStats();
+}
 
-void ULRUTextureAtlas::MoveToTail(Index* node)
+bool ULRUTextureAtlas::Evict(int32 Count)
 {
 	FScopeLock Lock(&LRUMutex);
-	node->Remove();
-	LRU.AddTail(node);
-}
\ No newline at end of file
+	Nodes.FlushTouchesLocked();
+
+	int32 EvictedCount = 0;
+
+	// Head is the least recently released item. Referenced items are not in the list.
+	while (EvictedCount < Count)
+	{
+		const int32 NodeIndex = Nodes.RetireHeadLocked();
+		if (NodeIndex == INDEX_NONE) break;
+
+		ReleaseTileLocked(NodeIndex);
+		++EvictedCount;
+	}
+
+	return EvictedCount == Count;
+}
+
+bool ULRUTextureAtlas::EvictLocked(int32 NodeIndex)
+{
+	if (!Nodes.RetireLocked(NodeIndex)) return false;
+
+	ReleaseTileLocked(NodeIndex);
+	return true;
+}
+
+void ULRUTextureAtlas::ReleaseTileLocked(int32 NodeIndex)
+{
+	// Keys go in the same step, so a lookup never finds an evicted tile
+	uint64 Key;
+	if (NodeKeys.RemoveAndCopyValue(NodeIndex, Key))
+	{
+		KeyedTiles.Remove(Key);
+		++CacheStats.Evictions;
+	}
+
+	// Notifies anyone that a coordinate will be released
+	const FIntPoint TileIndex = Nodes.GetValue(NodeIndex);
+	OnEvict.Broadcast(TileIndex);
+
+	// The tile is free right away, the node waits until no upgrade can still reach it
+	ReleaseTileIndex(TileIndex);
+}
+
+void ULRUTextureAtlas::FlushTouches()
+{
+	if (!Nodes.IsDeferringTouches()) return;
+
+	FScopeLock Lock(&LRUMutex);
+	Nodes.FlushTouchesLocked();
+}
+
+void ULRUTextureAtlas::TrimNodes()
+{
+	FScopeLock Lock(&LRUMutex);
+	Nodes.TrimLocked();
+}
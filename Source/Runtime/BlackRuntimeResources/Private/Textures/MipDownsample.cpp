@@ -0,0 +1,164 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "MipDownsample.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#elif PLATFORM_CPU_ARM_FAMILY
+#include <arm_neon.h>
+#endif
+
+namespace MipDownsample
+{
+	namespace
+	{
+		bool IsUnorm8(EPixelFormat Format)
+		{
+			switch (Format)
+			{
+			case PF_B8G8R8A8:
+			case PF_R8G8B8A8:
+			case PF_A8R8G8B8:
+			case PF_G8:
+			case PF_A8:
+			case PF_R8:
+			case PF_R8G8:
+			case PF_L8:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		bool IsFloat32(EPixelFormat Format)
+		{
+			switch (Format)
+			{
+			case PF_R32_FLOAT:
+			case PF_G32R32F:
+			case PF_A32B32G32R32F:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Rounded average of four bytes
+		FORCEINLINE uint8 Average(uint32 A, uint32 B, uint32 C, uint32 D)
+		{
+			return uint8((A + B + C + D + 2) >> 2);
+		}
+
+		void DownsampleUnorm8Scalar(
+			const uint8* Row0, const uint8* Row1,
+			uint8* Out,
+			int32 FirstPixel, int32 DestWidth, int32 Bpp)
+		{
+			for (int32 x = FirstPixel; x < DestWidth; ++x)
+			{
+				const uint8* A = Row0 + x * 2 * Bpp;
+				const uint8* B = Row1 + x * 2 * Bpp;
+				for (int32 c = 0; c < Bpp; ++c)
+				{
+					Out[x * Bpp + c] = Average(A[c], A[c + Bpp], B[c], B[c + Bpp]);
+				}
+			}
+		}
+
+		// Four 32 bit pixels per iteration, rounding twice so results may be one step above the
+		// exact average. Returns how many destination pixels were written.
+		int32 DownsampleRGBA8Simd(const uint8* Row0, const uint8* Row1, uint8* Out, int32 DestWidth)
+		{
+			int32 x = 0;
+
+#if PLATFORM_CPU_X86_FAMILY
+			for (; x + 4 <= DestWidth; x += 4)
+			{
+				const __m128i A0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row0 + x * 8));
+				const __m128i A1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row0 + x * 8 + 16));
+				const __m128i B0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row1 + x * 8));
+				const __m128i B1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row1 + x * 8 + 16));
+
+				// Vertical pairs
+				const __m128i V0 = _mm_avg_epu8(A0, B0);
+				const __m128i V1 = _mm_avg_epu8(A1, B1);
+
+				// Split even and odd pixels, then average the horizontal pairs
+				const __m128i Even = _mm_unpacklo_epi64(
+					_mm_shuffle_epi32(V0, _MM_SHUFFLE(3, 1, 2, 0)),
+					_mm_shuffle_epi32(V1, _MM_SHUFFLE(3, 1, 2, 0)));
+				const __m128i Odd = _mm_unpackhi_epi64(
+					_mm_shuffle_epi32(V0, _MM_SHUFFLE(3, 1, 2, 0)),
+					_mm_shuffle_epi32(V1, _MM_SHUFFLE(3, 1, 2, 0)));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + x * 4), _mm_avg_epu8(Even, Odd));
+			}
+#elif PLATFORM_CPU_ARM_FAMILY
+			for (; x + 4 <= DestWidth; x += 4)
+			{
+				// De-interleaves even and odd pixels on load
+				const uint32x4x2_t A = vld2q_u32(reinterpret_cast<const uint32*>(Row0 + x * 8));
+				const uint32x4x2_t B = vld2q_u32(reinterpret_cast<const uint32*>(Row1 + x * 8));
+
+				const uint8x16_t Top = vrhaddq_u8(vreinterpretq_u8_u32(A.val[0]), vreinterpretq_u8_u32(A.val[1]));
+				const uint8x16_t Bottom = vrhaddq_u8(vreinterpretq_u8_u32(B.val[0]), vreinterpretq_u8_u32(B.val[1]));
+
+				vst1q_u8(Out + x * 4, vrhaddq_u8(Top, Bottom));
+			}
+#endif
+
+			return x;
+		}
+
+		void DownsampleFloat32(
+			const uint8* Row0, const uint8* Row1,
+			uint8* Out,
+			int32 DestWidth, int32 Channels)
+		{
+			const float* A = reinterpret_cast<const float*>(Row0);
+			const float* B = reinterpret_cast<const float*>(Row1);
+			float* Dest = reinterpret_cast<float*>(Out);
+
+			for (int32 x = 0; x < DestWidth; ++x)
+			{
+				for (int32 c = 0; c < Channels; ++c)
+				{
+					const int32 Left = x * 2 * Channels + c;
+					Dest[x * Channels + c] = 0.25f * (A[Left] + A[Left + Channels] + B[Left] + B[Left + Channels]);
+				}
+			}
+		}
+	}
+
+	bool SupportsFormat(EPixelFormat Format)
+	{
+		return IsUnorm8(Format) || IsFloat32(Format);
+	}
+
+	void Downsample2x(
+		const uint8* Source, int32 SourcePitch,
+		uint8* Dest, int32 DestPitch,
+		int32 DestWidth, int32 DestHeight,
+		EPixelFormat Format)
+	{
+		check(SupportsFormat(Format));
+		const int32 Bpp = GPixelFormats[Format].BlockBytes;
+
+		for (int32 y = 0; y < DestHeight; ++y)
+		{
+			const uint8* Row0 = Source + (y * 2) * SourcePitch;
+			const uint8* Row1 = Row0 + SourcePitch;
+			uint8* Out = Dest + y * DestPitch;
+
+			if (IsFloat32(Format))
+			{
+				DownsampleFloat32(Row0, Row1, Out, DestWidth, Bpp / 4);
+				continue;
+			}
+
+			// The vector path covers 32 bit pixels, the scalar loop finishes the row
+			const int32 Done = Bpp == 4 ? DownsampleRGBA8Simd(Row0, Row1, Out, DestWidth) : 0;
+			DownsampleUnorm8Scalar(Row0, Row1, Out, Done, DestWidth, Bpp);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace MipDownsample
+{
+	// True if Downsample2x has a box filter for this format (8 bit or 32 bit float channels)
+	bool SupportsFormat(EPixelFormat Format);
+
+	// 2x2 box filter from a (2 * DestWidth) x (2 * DestHeight) source into Dest
+	void Downsample2x(
+		const uint8* Source, int32 SourcePitch,
+		uint8* Dest, int32 DestPitch,
+		int32 DestWidth, int32 DestHeight,
+		EPixelFormat Format);
+}
@@ -0,0 +1,231 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Textures/PackedTextureAtlas.h"
+#include "TileExtrusion.h"
+#include "Engine/Texture2D.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "TextureResource.h"
+
+void UPackedTextureAtlas::InitializePacked(
+	int32 InAtlasWidth, int32 InAtlasHeight,
+	int32 InTilePadding, EPixelFormat InFormat
+)
+{
+	FScopeLock Lock(&LRUMutex);
+
+	AtlasWidth = InAtlasWidth;
+	AtlasHeight = InAtlasHeight;
+	TilePadding = InTilePadding;
+	PixelFormat = InFormat;
+
+	// Packed rects are not aligned to any mip or block grid, so the atlas stays single mip and
+	// uncompressed
+	NumMips = 1;
+	TextureFormat = PixelFormat;
+
+	Packer.Init(AtlasWidth, AtlasHeight);
+	Nodes.Init(LRUMutex);
+	CreateAtlasTexture();
+	bInitialized = true;
+}
+
+void UPackedTextureAtlas::Initialize(
+	int32 InAtlasWidth, int32 InAtlasHeight,
+	int32 InTileWidth, int32 InTileHeight,
+	int32 InTilePadding, EPixelFormat InFormat
+)
+{
+	InitializePacked(InAtlasWidth, InAtlasHeight, InTilePadding, InFormat);
+}
+
+UPackedTextureAtlas::RectHandle UPackedTextureAtlas::Allocate(FIntPoint Size)
+{
+	check(IsInitialized());
+	FScopeLock Lock(&LRUMutex);
+
+	const FIntPoint PaddedSize = Size + FIntPoint(TilePadding * 2, TilePadding * 2);
+
+	// Evicts least recently released rects until the padded size fits
+	FIntRect Padded;
+	while (!Packer.Allocate(PaddedSize.X, PaddedSize.Y, Padded))
+	{
+		// Rects referenced while waiting on the lock are skipped; their own touch will settle them
+		const int32 NodeIndex = Nodes.RetireHeadLocked();
+		if (NodeIndex == INDEX_NONE) return RectHandle();
+
+		ReleaseRectLocked(NodeIndex, true);
+	}
+
+	// Freed nodes come back once no handle can still be upgrading them
+	Nodes.ReclaimLocked();
+
+	// Unreferenced until acquired, so it starts at the tail of the eviction list
+	return Nodes.AddLocked(FIntRect(
+		Padded.Min + FIntPoint(TilePadding, TilePadding),
+		Padded.Max - FIntPoint(TilePadding, TilePadding)));
+}
+
+bool UPackedTextureAtlas::Free(RectHandle Handle)
+{
+	FScopeLock Lock(&LRUMutex);
+
+	// Stale handles fail here, so a handle kept past its rect never frees the node's next one
+	int32 NodeIndex = INDEX_NONE;
+	{
+		RectCounter Counter = Acquire(Handle);
+		if (!Counter || Counter->GetRefCount() != 1) return false;
+		NodeIndex = Counter->GetNodeIndex();
+	}
+
+	// Released under the lock, so only a racing upgrade can have bumped it again
+	return FreeLocked(NodeIndex, false);
+}
+
+void UPackedTextureAtlas::FreeUnused()
+{
+	FScopeLock Lock(&LRUMutex);
+
+	for (int32 NodeIndex = Nodes.RetireHeadLocked(); NodeIndex != INDEX_NONE; NodeIndex = Nodes.RetireHeadLocked())
+	{
+		ReleaseRectLocked(NodeIndex, true);
+	}
+}
+
+void UPackedTextureAtlas::WriteRects(
+	TArray<RectCounter>& Rects,
+	TArray<uint8>& PixelData
+)
+{
+	check(IsInitialized());
+
+	const int32 BytesPerPixel = GPixelFormats[PixelFormat].BlockBytes;
+	const bool bExtruding = IsExtrudingPadding();
+	const int32 Padding = bExtruding ? TilePadding : 0;
+
+	// Rects differ in size, so the batch is filled here instead of by the tile stages
+	TUniquePtr<FTextureAtlasUploadBatch> Batch = UploadPool->AcquireBatch();
+
+	// Padded copies are sized once up front, so the write sources stay valid
+	int64 PaddedBytes = 0;
+	if (bExtruding)
+	{
+		for (const RectCounter& Counter : Rects)
+		{
+			check(Counter);
+			const FIntRect Dest = *Counter;
+			PaddedBytes += int64(Dest.Width() + Padding * 2) * (Dest.Height() + Padding * 2) * BytesPerPixel;
+		}
+
+		check(PaddedBytes <= MAX_int32);
+		Batch->ExtrudedPixels.SetNumUninitialized(int32(PaddedBytes), EAllowShrinking::No);
+	}
+
+	int64 Offset = 0;
+	int64 PaddedOffset = 0;
+
+	for (int32 i = 0; i < Rects.Num(); ++i)
+	{
+		check(Rects[i]);
+		const FIntRect Dest = *Rects[i];
+
+		check(PixelData.Num() >= Offset + int64(Dest.Width()) * Dest.Height() * BytesPerPixel);
+		const uint8* Source = PixelData.GetData() + Offset;
+
+		const FIntPoint Size(Dest.Width() + Padding * 2, Dest.Height() + Padding * 2);
+		if (bExtruding)
+		{
+			uint8* Padded = Batch->ExtrudedPixels.GetData() + PaddedOffset;
+			TileExtrusion::ExtrudeTile(
+				Source, Dest.Width() * BytesPerPixel,
+				Padded,
+				Dest.Width(), Dest.Height(), Padding,
+				BytesPerPixel);
+
+			Source = Padded;
+			PaddedOffset += int64(Size.X) * Size.Y * BytesPerPixel;
+		}
+
+		Batch->Writes.Add({ Dest.Min, Source });
+		Batch->Regions.Add(FUpdateTextureRegion2D(Dest.Min.X - Padding, Dest.Min.Y - Padding, 0, 0, Size.X, Size.Y));
+		Batch->Pitches.Add(Size.X * BytesPerPixel);
+
+		Offset += int64(Dest.Width()) * Dest.Height() * BytesPerPixel;
+	}
+
+	SubmitUploadBatch(MoveTemp(Batch));
+}
+
+void UPackedTextureAtlas::SubmitUploadBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch)
+{
+	check(Batch->Regions.Num() == Batch->Writes.Num() && Batch->Pitches.Num() == Batch->Writes.Num());
+	FTextureResource* Resource = AtlasTexture->GetResource();
+
+	ENQUEUE_RENDER_COMMAND(PackedAtlasFlushUploads)(
+		[Resource, Batch = MoveTemp(Batch), Pool = UploadPool](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			FRHITexture* Texture = Resource->TextureRHI;
+			for (int32 i = 0; i < Batch->Writes.Num(); ++i)
+			{
+				RHICmdList.UpdateTexture2D(Texture, 0, Batch->Regions[i], Batch->Pitches[i], Batch->Writes[i].Source);
+			}
+
+			Pool->ReleaseBatch(MoveTemp(Batch));
+		});
+}
+
+FVector2D UPackedTextureAtlas::GetRectUVOffset(const FIntRect& InRect) const
+{
+	check(IsInitialized());
+
+	return FVector2D(
+		float(InRect.Min.X) / float(AtlasWidth),
+		float(InRect.Min.Y) / float(AtlasHeight)
+	);
+}
+
+FVector2D UPackedTextureAtlas::GetRectUVSize(const FIntRect& InRect) const
+{
+	check(IsInitialized());
+
+	return FVector2D(
+		float(InRect.Width()) / float(AtlasWidth),
+		float(InRect.Height()) / float(AtlasHeight)
+	);
+}
+
+float UPackedTextureAtlas::GetFragmentation() const
+{
+	FScopeLock Lock(&LRUMutex);
+	return Packer.GetFragmentation();
+}
+
+float UPackedTextureAtlas::GetOccupancy() const
+{
+	FScopeLock Lock(&LRUMutex);
+
+	const int64 Area = int64(Packer.GetWidth()) * Packer.GetHeight();
+	if (Area == 0) return 0.f;
+	return float(double(Area - Packer.GetFreeArea()) / double(Area));
+}
+
+bool UPackedTextureAtlas::FreeLocked(int32 NodeIndex, bool bBroadcast)
+{
+	if (!Nodes.RetireLocked(NodeIndex)) return false;
+
+	ReleaseRectLocked(NodeIndex, bBroadcast);
+	return true;
+}
+
+void UPackedTextureAtlas::ReleaseRectLocked(int32 NodeIndex, bool bBroadcast)
+{
+	const FIntRect Value = Nodes.GetValue(NodeIndex);
+
+	// Notifies anyone that a rect will be released
+	if (bBroadcast) OnEvict.Broadcast(Value.Min, Value.Max);
+
+	// The space is free right away, the node waits until no upgrade can still reach it
+	Packer.Free(FIntRect(
+		Value.Min - FIntPoint(TilePadding, TilePadding),
+		Value.Max + FIntPoint(TilePadding, TilePadding)));
+}
@@ -0,0 +1,316 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "Textures/PagedLRUTextureAtlas.h"
+#include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "TextureResource.h"
+#include "HAL/PlatformTime.h"
+
+void UPagedLRUTextureAtlas::Initialize(
+	int32 InAtlasWidth, int32 InAtlasHeight,
+	int32 InTileWidth, int32 InTileHeight,
+	int32 InTilePadding, EPixelFormat InFormat
+)
+{
+	// Pages are copied slice by slice from staging textures, which only cover mip 0
+	if (MipCount > 1)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPagedLRUTextureAtlas: mips are not supported for paged atlases, using a single mip."));
+		MipCount = 1;
+	}
+
+	Super::Initialize(
+		InAtlasWidth, InAtlasHeight,
+		InTileWidth, InTileHeight,
+		InTilePadding, InFormat
+	);
+
+	TilesPerColumn = GetMaxTileIndexY() + 1;
+	PageDivisor = blk::FGridDivisor(TilesPerColumn);
+}
+
+void UPagedLRUTextureAtlas::CreateAtlasTexture()
+{
+	check(MaxPageCount > 0);
+	ResolveExtrusion();
+
+	Pages.Reset();
+	AtlasTextureArray = nullptr;
+	ResizePages(1);
+}
+
+FIntVector UPagedLRUTextureAtlas::GetPagedTileIndex(FIntPoint TileIndex) const
+{
+	int32 Page, Y;
+	PageDivisor.DivMod(TileIndex.Y, Page, Y);
+	return FIntVector(TileIndex.X, Y, Page);
+}
+
+FVector UPagedLRUTextureAtlas::GetPagedTileUVOffset(FIntPoint TileIndex) const
+{
+	const FIntVector Paged = GetPagedTileIndex(TileIndex);
+	const FVector2D UV = GetTileUVOffset(FIntPoint(Paged.X, Paged.Y));
+	return FVector(UV.X, UV.Y, Paged.Z);
+}
+
+bool UPagedLRUTextureAtlas::IsValidTileIndex(FIntPoint TileIndex) const
+{
+	if (TileIndex.Y < 0) return false;
+
+	const FIntVector Paged = GetPagedTileIndex(TileIndex);
+	return Paged.Z < Pages.Num() && Super::IsValidTileIndex(FIntPoint(Paged.X, Paged.Y));
+}
+
+void UPagedLRUTextureAtlas::TrimPages()
+{
+	FScopeLock Lock(&LRUMutex);
+	Nodes.FlushTouchesLocked();
+
+	const double Now = FPlatformTime::Seconds();
+	int32 PageCount = Pages.Num();
+
+	// Only trailing pages can go without renumbering the slices of live tiles
+	while (PageCount > 1)
+	{
+		const int32 Page = PageCount - 1;
+		FPage& Last = Pages[Page];
+
+		if (Last.ReferencedTiles > 0)
+		{
+			Last.IdleSince = Now;
+			break;
+		}
+		if (Now - Last.IdleSince < PageReleaseCooldown) break;
+
+		// Every resident tile of the page is unreferenced and so on the LRU, and is dropped with
+		// the page. A handle can still revive one in the meantime, which pins the page after all.
+		bool bPinned = false;
+		int32 NodeIndex = Nodes.GetHeadLocked();
+		while (NodeIndex != INDEX_NONE && Last.ResidentTiles > 0 && !bPinned)
+		{
+			const int32 Next = Nodes.GetNextLocked(NodeIndex);
+
+			if (PageDivisor.Divide(Nodes.GetValue(NodeIndex).Y) == Page) bPinned = !EvictLocked(NodeIndex);
+			NodeIndex = Next;
+		}
+
+		if (bPinned)
+		{
+			Last.IdleSince = Now;
+			break;
+		}
+
+		check(Last.ResidentTiles == 0);
+		--PageCount;
+	}
+
+	if (PageCount != Pages.Num()) ResizePages(PageCount);
+
+	// Nodes of the evicted tiles go with their chunks once reclaimed
+	Nodes.TrimLocked();
+}
+
+void UPagedLRUTextureAtlas::SubmitUploadBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch)
+{
+	FTextureResource* PageResource = AtlasTextureArray->GetResource();
+	const uint32 Pitch = GetUploadPitch();
+	const EPixelFormat Format = TextureFormat;
+
+	// Regions hold slice positions, the slice of each write is kept alongside. Each staged page
+	// gets the bounds of its writes, cells are whole blocks so the bounds are too.
+	TArray<int32, TInlineAllocator<8>> StagedPages;
+	TArray<FIntRect, TInlineAllocator<8>> StagedBounds;
+
+	for (const FTextureAtlasTileWrite& Write : Batch->Writes)
+	{
+		const FIntVector Paged = GetPagedTileIndex(Write.TileIndex);
+		const FUpdateTextureRegion2D Region = GetUploadRegion(FIntPoint(Paged.X, Paged.Y));
+		const FIntRect Bounds(Region.DestX, Region.DestY, Region.DestX + Region.Width, Region.DestY + Region.Height);
+
+		Batch->Regions.Add(Region);
+		Batch->Slices.Add(Paged.Z);
+
+		const int32 Staged = StagedPages.Find(Paged.Z);
+		if (Staged == INDEX_NONE)
+		{
+			StagedPages.Add(Paged.Z);
+			StagedBounds.Add(Bounds);
+		}
+		else
+		{
+			StagedBounds[Staged].Union(Bounds);
+		}
+	}
+
+	// One staging texture fits every page's bounds, and is dropped once the batch is copied
+	FIntPoint StagingSize = FIntPoint::ZeroValue;
+	for (const FIntRect& Bounds : StagedBounds)
+	{
+		StagingSize = StagingSize.ComponentMax(Bounds.Size());
+	}
+
+	ENQUEUE_RENDER_COMMAND(PagedAtlasFlushUploads)(
+		[PageResource, Pitch, Format, StagingSize,
+		 StagedPages = MoveTemp(StagedPages), StagedBounds = MoveTemp(StagedBounds),
+		 Batch = MoveTemp(Batch), Pool = UploadPool](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			if (StagedPages.IsEmpty())
+			{
+				Pool->ReleaseBatch(MoveTemp(Batch));
+				return;
+			}
+
+			const FRHITextureCreateDesc Desc =
+				FRHITextureCreateDesc::Create2D(TEXT("PagedAtlasStaging"), StagingSize.X, StagingSize.Y, Format)
+				.SetInitialState(ERHIAccess::CopyDest);
+			FTextureRHIRef Staging = RHICreateTexture(Desc);
+			FRHITexture* PageArray = PageResource->TextureRHI;
+
+			// Tiles on different pages can share a staging position, so pages go one at a time
+			for (int32 p = 0; p < StagedPages.Num(); ++p)
+			{
+				const int32 Page = StagedPages[p];
+				const FIntPoint Origin = StagedBounds[p].Min;
+
+				for (int32 i = 0; i < Batch->Writes.Num(); ++i)
+				{
+					if (Batch->Slices[i] != Page) continue;
+
+					FUpdateTextureRegion2D Region = Batch->Regions[i];
+					Region.DestX -= Origin.X;
+					Region.DestY -= Origin.Y;
+					RHICmdList.UpdateTexture2D(Staging, 0, Region, Pitch, Batch->Writes[i].Source);
+				}
+
+				RHICmdList.Transition({
+					FRHITransitionInfo(Staging, ERHIAccess::CopyDest, ERHIAccess::CopySrc),
+					FRHITransitionInfo(PageArray, ERHIAccess::SRVMask, ERHIAccess::CopyDest)
+				});
+
+				for (int32 i = 0; i < Batch->Writes.Num(); ++i)
+				{
+					if (Batch->Slices[i] != Page) continue;
+
+					const FUpdateTextureRegion2D& Region = Batch->Regions[i];
+					FRHICopyTextureInfo CopyInfo;
+					CopyInfo.Size = FIntVector(Region.Width, Region.Height, 1);
+					CopyInfo.SourcePosition = FIntVector(Region.DestX - Origin.X, Region.DestY - Origin.Y, 0);
+					CopyInfo.DestPosition = FIntVector(Region.DestX, Region.DestY, 0);
+					CopyInfo.DestSliceIndex = Page;
+					RHICmdList.CopyTexture(Staging, PageArray, CopyInfo);
+				}
+
+				RHICmdList.Transition({
+					FRHITransitionInfo(Staging, ERHIAccess::CopySrc, ERHIAccess::CopyDest),
+					FRHITransitionInfo(PageArray, ERHIAccess::CopyDest, ERHIAccess::SRVMask)
+				});
+			}
+
+			Pool->ReleaseBatch(MoveTemp(Batch));
+		});
+}
+
+int32 UPagedLRUTextureAtlas::GetTileCapacity() const
+{
+	return Pages.Num() * GetMaxTileCount();
+}
+
+void UPagedLRUTextureAtlas::GrowCapacity(int32 RequiredTiles)
+{
+	FScopeLock Lock(&LRUMutex);
+
+	int32 PageCount = Pages.Num();
+	while (PageCount < MaxPageCount && RequiredTiles > GrowThreshold * PageCount * GetMaxTileCount())
+	{
+		++PageCount;
+	}
+
+	if (PageCount != Pages.Num()) ResizePages(PageCount);
+}
+
+FIntPoint UPagedLRUTextureAtlas::AcquireTileIndex()
+{
+	// Lowest page first, so trailing pages drain and can be released
+	for (int32 Page = 0; Page < Pages.Num(); ++Page)
+	{
+		FPage& Current = Pages[Page];
+		if (Current.ResidentTiles == GetMaxTileCount()) continue;
+
+		++Current.ResidentTiles;
+		const FIntPoint TileIndex = Current.TilePool.Acquire();
+		return FIntPoint(TileIndex.X, Page * TilesPerColumn + TileIndex.Y);
+	}
+
+	checkf(false, TEXT("UPagedLRUTextureAtlas::AcquireTileIndex called with every page full"));
+	return FIntPoint();
+}
+
+void UPagedLRUTextureAtlas::ReleaseTileIndex(FIntPoint TileIndex)
+{
+	const FIntVector Paged = GetPagedTileIndex(TileIndex);
+	FPage& Page = Pages[Paged.Z];
+
+	--Page.ResidentTiles;
+	Page.TilePool.Release(FIntPoint(Paged.X, Paged.Y));
+}
+
+void UPagedLRUTextureAtlas::OnTileTouched(FIntPoint TileIndex, bool bReferenced)
+{
+	// Hot pages are stamped on every pin and unpin, not only when TrimPages sees a pinned tile
+	FPage& Page = Pages[PageDivisor.Divide(TileIndex.Y)];
+	Page.ReferencedTiles += bReferenced ? 1 : -1;
+	Page.IdleSince = FPlatformTime::Seconds();
+	check(Page.ReferencedTiles >= 0 && Page.ReferencedTiles <= Page.ResidentTiles);
+}
+
+void UPagedLRUTextureAtlas::ResizePages(int32 PageCount)
+{
+	const int32 PreviousCount = Pages.Num();
+	const double Now = FPlatformTime::Seconds();
+
+	Pages.SetNum(PageCount);
+	for (int32 Page = PreviousCount; Page < PageCount; ++Page)
+	{
+		Pages[Page].TilePool.SetMortonExtent(GetMaxTileIndexX() + 1, GetMaxTileIndexY() + 1);
+		Pages[Page].IdleSince = Now;
+	}
+
+	UTexture2DArray* Previous = AtlasTextureArray;
+
+	AtlasTextureArray = UTexture2DArray::CreateTransient(AtlasWidth, AtlasHeight, PageCount, TextureFormat);
+	AtlasTextureArray->Filter = TF_Nearest;
+	AtlasTextureArray->SRGB = false;
+	AtlasTextureArray->UpdateResource();
+
+	// Copies the surviving slices after the new resource has been initialized
+	if (Previous)
+	{
+		FTextureResource* Source = Previous->GetResource();
+		FTextureResource* Dest = AtlasTextureArray->GetResource();
+		const int32 CopiedPages = FMath::Min(PreviousCount, PageCount);
+		const FIntVector Size(AtlasWidth, AtlasHeight, 1);
+
+		ENQUEUE_RENDER_COMMAND(PagedAtlasCopyPages)(
+			[Source, Dest, CopiedPages, Size](FRHICommandListImmediate& RHICmdList)
+			{
+				RHICmdList.Transition({
+					FRHITransitionInfo(Source->TextureRHI, ERHIAccess::SRVMask, ERHIAccess::CopySrc),
+					FRHITransitionInfo(Dest->TextureRHI, ERHIAccess::SRVMask, ERHIAccess::CopyDest)
+				});
+
+				FRHICopyTextureInfo CopyInfo;
+				CopyInfo.Size = Size;
+				CopyInfo.NumSlices = CopiedPages;
+				RHICmdList.CopyTexture(Source->TextureRHI, Dest->TextureRHI, CopyInfo);
+
+				RHICmdList.Transition({
+					FRHITransitionInfo(Source->TextureRHI, ERHIAccess::CopySrc, ERHIAccess::SRVMask),
+					FRHITransitionInfo(Dest->TextureRHI, ERHIAccess::CopyDest, ERHIAccess::SRVMask)
+				});
+			});
+	}
+
+	OnPagesResized.Broadcast(AtlasTextureArray);
+}
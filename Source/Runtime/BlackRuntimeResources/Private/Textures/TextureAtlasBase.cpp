@@ -1,6 +1,62 @@
 // Copyright (c) Black Megacorp. All Rights Reserved.
 
 #include "Textures/TextureAtlasBase.h"
+#include "TileExtrusion.h"
+#include "MipDownsample.h"
+#include "BlockCompression.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "TextureResource.h"
+#include "HAL/PlatformTime.h"
+#include "Containers/FrameAllocator.h"
+
+void FTextureAtlasUploadBatch::Reset()
+{
+	OwnedBuffers.Reset();
+	SharedBuffers.Reset();
+	Writes.Reset();
+	Regions.Reset();
+	Slices.Reset();
+	Pitches.Reset();
+	ExtrudedPixels.Reset();
+	MipWrites.Reset();
+	MipPixels.Reset();
+	EncodedPixels.Reset();
+}
+
+TArray<uint8> FTextureAtlasUploadPool::AcquireBuffer()
+{
+	FScopeLock Lock(&Mutex);
+	if (FreeBuffers.IsEmpty()) return TArray<uint8>();
+	return FreeBuffers.Pop(EAllowShrinking::No);
+}
+
+void FTextureAtlasUploadPool::ReleaseBuffer(TArray<uint8>&& Buffer)
+{
+	Buffer.Reset();
+
+	FScopeLock Lock(&Mutex);
+	if (FreeBuffers.Num() < MaxPooledBuffers) FreeBuffers.Add(MoveTemp(Buffer));
+}
+
+TUniquePtr<FTextureAtlasUploadBatch> FTextureAtlasUploadPool::AcquireBatch()
+{
+	return TUniquePtr<FTextureAtlasUploadBatch>(Batches.Acquire());
+}
+
+void FTextureAtlasUploadPool::ReleaseBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch)
+{
+	// Owned buffers keep their allocations for the next producer
+	for (TArray<uint8>& Buffer : Batch->OwnedBuffers)
+	{
+		ReleaseBuffer(MoveTemp(Buffer));
+	}
+	Batch->Reset();
+
+	Batches.Release(Batch.Release());
+}
 
 FVector2D UTextureAtlasBase::GetTileUVSize() const
 {
@@ -15,7 +71,7 @@ FVector2D UTextureAtlasBase::GetTileUVSize() const
 FVector2D UTextureAtlasBase::GetTileUVOffset(FIntPoint TileIndex) const
 {
 	check(IsInitialized());
-	check(TileIndex.X < MaxTileIndexX && TileIndex.Y < MaxTileIndexY);
+	check(TileIndex.X <= MaxTileIndexX && TileIndex.Y <= MaxTileIndexY);
 
 	return FVector2D(
 		TileIndex.X * TileUVStepX + PaddingUVStepX,
@@ -36,6 +92,10 @@ void UTextureAtlasBase::Initialize(
 	TilePadding = InTilePadding;
 	PixelFormat = InFormat;
 
+	// Encoded uploads are whole block aligned cells, so the gutters have to be filled
+	TextureFormat = ResolveTextureFormat();
+	if (IsCompressing()) bExtrudePadding = true;
+
 	MaxTileIndexX = AtlasWidth / (TileWidth + TilePadding * 2) - 1;
 	MaxTileIndexY = AtlasHeight / (TileHeight + TilePadding * 2) - 1;
 	MaxTileCount = (MaxTileIndexX + 1) * (MaxTileIndexY + 1);
@@ -45,57 +105,471 @@ void UTextureAtlasBase::Initialize(
 	PaddingUVStepX = float(TilePadding) / float(AtlasWidth);
 	PaddingUVStepY = float(TilePadding) / float(AtlasHeight);
 
-	AtlasTexture = UTexture2D::CreateTransient(AtlasWidth, AtlasHeight, PixelFormat);
-	AtlasTexture->Filter = TF_Nearest;
+	// Lower mips are built from whole cells, so the gutters have to be filled
+	NumMips = ResolveMipCount();
+	if (NumMips > 1) bExtrudePadding = true;
+
+	CreateAtlasTexture();
+	bInitialized = true;
+}
+
+EPixelFormat UTextureAtlasBase::ResolveTextureFormat()
+{
+	if (Compression == ETextureAtlasCompression::None) return PixelFormat;
+
+	const EPixelFormat Compressed = BlockCompression::GetCompressedFormat(Compression, PixelFormat);
+	if (Compressed == PF_Unknown)
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("UTextureAtlasBase: %s tiles can not be encoded with the requested compression, storing them uncompressed."),
+			GPixelFormats[PixelFormat].Name);
+		return PixelFormat;
+	}
+
+	const int32 BlockSize = GPixelFormats[Compressed].BlockSizeX;
+	if (TileWidth % 2 != 0 || TileHeight % 2 != 0)
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("UTextureAtlasBase: %dx%d tiles can not be padded to %d pixel blocks, storing them uncompressed."),
+			TileWidth, TileHeight, BlockSize);
+		return PixelFormat;
+	}
+
+	// Grows the padding until both cell sides are whole blocks
+	while ((TileWidth + TilePadding * 2) % BlockSize != 0 || (TileHeight + TilePadding * 2) % BlockSize != 0)
+	{
+		++TilePadding;
+	}
+
+	// Partial blocks at the right and bottom edges never hold a cell
+	AtlasWidth -= AtlasWidth % BlockSize;
+	AtlasHeight -= AtlasHeight % BlockSize;
+
+	return Compressed;
+}
+
+int32 UTextureAtlasBase::ResolveMipCount() const
+{
+	if (MipCount <= 1) return 1;
+
+	if (!MipDownsample::SupportsFormat(PixelFormat))
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("UTextureAtlasBase: mips need 8 bit or 32 bit float channels, using a single mip."));
+		return 1;
+	}
+
+	const int32 CellWidth = TileWidth + TilePadding * 2;
+	const int32 CellHeight = TileHeight + TilePadding * 2;
+	const int32 BlockSize = GPixelFormats[TextureFormat].BlockSizeX;
+
+	// Each mip has to halve the cells into whole blocks and keep at least one gutter pixel
+	int32 Mips = 1;
+	while (Mips < MipCount)
+	{
+		const int32 Step = 1 << Mips;
+		if (CellWidth % (Step * BlockSize) != 0 || CellHeight % (Step * BlockSize) != 0) break;
+		if (TilePadding > 0 && TilePadding < Step) break;
+		++Mips;
+	}
+
+	if (Mips < MipCount)
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("UTextureAtlasBase: %d mips requested, but %dx%d tile cells with %d padding only allow %d."),
+			MipCount, CellWidth, CellHeight, TilePadding, Mips);
+	}
+
+	return Mips;
+}
+
+bool UTextureAtlasBase::IsExtrudingPadding() const
+{
+	return bExtrudePadding && TilePadding > 0;
+}
+
+void UTextureAtlasBase::ResolveExtrusion()
+{
+	if (bExtrudePadding && !TileExtrusion::SupportsFormat(PixelFormat))
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("UTextureAtlasBase: padding extrusion is not supported for block compressed formats, disabling it."));
+		bExtrudePadding = false;
+	}
+}
+
+void UTextureAtlasBase::CreateAtlasTexture()
+{
+	ResolveExtrusion();
+
+	AtlasTexture = UTexture2D::CreateTransient(AtlasWidth, AtlasHeight, TextureFormat);
+	AtlasTexture->Filter = NumMips > 1 ? TF_Trilinear : TF_Nearest;
+
+	// Lower mips start cleared and are filled tile by tile as they are written
+	FTexturePlatformData* PlatformData = AtlasTexture->GetPlatformData();
+	const FPixelFormatInfo& Info = GPixelFormats[TextureFormat];
+	for (int32 Mip = 1; Mip < NumMips; ++Mip)
+	{
+		FTexture2DMipMap* MipMap = new FTexture2DMipMap(
+			FMath::Max(AtlasWidth >> Mip, 1),
+			FMath::Max(AtlasHeight >> Mip, 1));
+		const int64 NumBytes = int64(FMath::DivideAndRoundUp(MipMap->SizeX, Info.BlockSizeX))
+			* FMath::DivideAndRoundUp(MipMap->SizeY, Info.BlockSizeY)
+			* Info.BlockBytes;
+
+		MipMap->BulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memzero(MipMap->BulkData.Realloc(NumBytes), NumBytes);
+		MipMap->BulkData.Unlock();
+
+		PlatformData->Mips.Add(MipMap);
+	}
+
 	AtlasTexture->NeverStream = true;
 	AtlasTexture->SRGB = false;
 	AtlasTexture->UpdateResource();
 }
 
+bool UTextureAtlasBase::IsValidTileIndex(FIntPoint TileIndex) const
+{
+	return TileIndex.X >= 0 && TileIndex.X <= MaxTileIndexX
+		&& TileIndex.Y >= 0 && TileIndex.Y <= MaxTileIndexY;
+}
+
 void UTextureAtlasBase::WriteTile(
 	FIntPoint Index,
 	TArray<uint8>& PixelData
 )
 {
-	TArray<FIntPoint> TileIndices({ Index });
-	WriteTiles(TileIndices, PixelData);
+	WriteTiles(MakeArrayView(&Index, 1), PixelData);
 }
 
 void UTextureAtlasBase::WriteTiles(
-	TArray<FIntPoint>& TileIndices,
+	TArrayView<const FIntPoint> TileIndices,
 	TArray<uint8>& PixelData
 )
 {
 	check(IsInitialized());
 
-	int32 BytesPerPixel = GPixelFormats[PixelFormat].BlockBytes;
-	int32 TileCount = TileIndices.Num();
+	const int32 TileBytes = TileWidth * TileHeight * GPixelFormats[PixelFormat].BlockBytes;
+	const int32 TileCount = TileIndices.Num();
 
-	check(PixelData.Num() >= TileWidth * TileHeight * BytesPerPixel * TileCount);
+	check(PixelData.Num() >= TileBytes * TileCount);
 
-	TArray<FUpdateTextureRegion2D> Regions;
+	// Borrows PixelData, the caller keeps it alive until the render thread has uploaded it
+	TUniquePtr<FTextureAtlasUploadBatch> Batch = UploadPool->AcquireBatch();
 
 	for (int32 i = 0; i < TileCount; ++i)
 	{
 		FIntPoint Index = TileIndices[i];
-		check(Index.X <= MaxTileIndexX && Index.Y <= MaxTileIndexY);
-
-		FUpdateTextureRegion2D Region;
-		Region.DestX = (TilePadding * 2 + TileWidth) * Index.X;
-		Region.DestY = (TilePadding * 2 + TileHeight) * Index.Y;
-		Region.SrcX = 0;
-		Region.SrcY = TileHeight * i;
-		Region.Width = TileWidth;
-		Region.Height = TileHeight;
-		Regions.Add(Region);
-	}
-
-	AtlasTexture->UpdateTextureRegions(
-		0,
-		TileCount,
-		Regions.GetData(),
-		TileWidth * BytesPerPixel,
-		BytesPerPixel,
-		PixelData.GetData()
-	);
+		check(IsValidTileIndex(Index));
+		Batch->Writes.Add({ Index, PixelData.GetData() + TileBytes * i });
+	}
+
+	SubmitUploads(MoveTemp(Batch));
+}
+
+TArray<uint8> UTextureAtlasBase::AcquireUploadBuffer()
+{
+	return UploadPool->AcquireBuffer();
+}
+
+void UTextureAtlasBase::QueueTileUpload(
+	TArray<FIntPoint>&& TileIndices,
+	TArray<uint8>&& PixelData,
+	TSharedPtr<void, ESPMode::ThreadSafe> KeepAlive
+)
+{
+	FQueuedTileUpload Upload;
+	Upload.TileIndices = MoveTemp(TileIndices);
+	Upload.OwnedPixels = MoveTemp(PixelData);
+	Upload.KeepAlive = MoveTemp(KeepAlive);
+	QueuedUploads.Enqueue(MoveTemp(Upload));
+}
+
+void UTextureAtlasBase::QueueTileUpload(
+	TArray<FIntPoint>&& TileIndices,
+	const TSharedRef<const TArray<uint8>, ESPMode::ThreadSafe>& PixelData,
+	TSharedPtr<void, ESPMode::ThreadSafe> KeepAlive
+)
+{
+	FQueuedTileUpload Upload;
+	Upload.TileIndices = MoveTemp(TileIndices);
+	Upload.SharedPixels = PixelData;
+	Upload.KeepAlive = MoveTemp(KeepAlive);
+	QueuedUploads.Enqueue(MoveTemp(Upload));
+}
+
+void UTextureAtlasBase::FlushUploads()
+{
+	check(IsInitialized());
+	if (QueuedUploads.IsEmpty()) return;
+
+	const int32 TileBytes = TileWidth * TileHeight * GPixelFormats[PixelFormat].BlockBytes;
+	TUniquePtr<FTextureAtlasUploadBatch> Batch = UploadPool->AcquireBatch();
+
+	// Held until the batch is on the render thread, later writes to the same tiles land after it
+	TArray<TSharedPtr<void, ESPMode::ThreadSafe>, TInlineAllocator<16>> KeepAlives;
+
+	FQueuedTileUpload Upload;
+	while (QueuedUploads.Dequeue(Upload))
+	{
+		if (Upload.KeepAlive.IsValid()) KeepAlives.Add(MoveTemp(Upload.KeepAlive));
+
+		// Moving the array keeps its heap block, so pointers into it stay valid
+		const uint8* Pixels;
+		int32 NumBytes;
+		if (Upload.SharedPixels.IsValid())
+		{
+			Pixels = Upload.SharedPixels->GetData();
+			NumBytes = Upload.SharedPixels->Num();
+			Batch->SharedBuffers.Add(Upload.SharedPixels.ToSharedRef());
+		}
+		else
+		{
+			Pixels = Upload.OwnedPixels.GetData();
+			NumBytes = Upload.OwnedPixels.Num();
+			Batch->OwnedBuffers.Add(MoveTemp(Upload.OwnedPixels));
+		}
+
+		check(NumBytes >= TileBytes * Upload.TileIndices.Num());
+
+		for (int32 i = 0; i < Upload.TileIndices.Num(); ++i)
+		{
+			const FIntPoint Index = Upload.TileIndices[i];
+			check(IsValidTileIndex(Index));
+			Batch->Writes.Add({ Index, Pixels + TileBytes * i });
+		}
+
+		Upload.SharedPixels.Reset();
+	}
+
+	SubmitUploads(MoveTemp(Batch));
+}
+
+void UTextureAtlasBase::SubmitUploads(TUniquePtr<FTextureAtlasUploadBatch>&& Batch)
+{
+	if (IsExtrudingPadding()) ExtrudeBatch(*Batch);
+	if (NumMips > 1) BuildMips(*Batch);
+	if (IsCompressing()) EncodeBatch(*Batch);
+	SubmitUploadBatch(MoveTemp(Batch));
+}
+
+void UTextureAtlasBase::ExtrudeBatch(FTextureAtlasUploadBatch& Batch)
+{
+	const int32 BytesPerPixel = GPixelFormats[PixelFormat].BlockBytes;
+	const int32 PaddedBytes = (TileWidth + TilePadding * 2) * (TileHeight + TilePadding * 2) * BytesPerPixel;
+	const int64 TotalBytes = int64(PaddedBytes) * Batch.Writes.Num();
+
+	// Sized once up front, so the repointed sources stay valid
+	check(TotalBytes <= MAX_int32);
+	Batch.ExtrudedPixels.SetNumUninitialized(int32(TotalBytes), EAllowShrinking::No);
+
+	for (int32 i = 0; i < Batch.Writes.Num(); ++i)
+	{
+		FTextureAtlasTileWrite& Write = Batch.Writes[i];
+		uint8* Dest = Batch.ExtrudedPixels.GetData() + int64(PaddedBytes) * i;
+
+		TileExtrusion::ExtrudeTile(
+			Write.Source, TileWidth * BytesPerPixel,
+			Dest,
+			TileWidth, TileHeight, TilePadding,
+			BytesPerPixel);
+
+		Write.Source = Dest;
+	}
+}
+
+void UTextureAtlasBase::BuildMips(FTextureAtlasUploadBatch& Batch)
+{
+	const int32 BytesPerPixel = GPixelFormats[PixelFormat].BlockBytes;
+	const int32 CellWidth = TileWidth + TilePadding * 2;
+	const int32 CellHeight = TileHeight + TilePadding * 2;
+	const int32 LowerMips = NumMips - 1;
+	const int32 WriteCount = Batch.Writes.Num();
+
+	// Bytes of one cell across every lower mip
+	int32 ChainBytes = 0;
+	for (int32 Mip = 1; Mip < NumMips; ++Mip)
+	{
+		ChainBytes += (CellWidth >> Mip) * (CellHeight >> Mip) * BytesPerPixel;
+	}
+
+	// Sized once up front, so the mip sources stay valid
+	const int64 TotalBytes = int64(ChainBytes) * WriteCount;
+	check(TotalBytes <= MAX_int32);
+	Batch.MipPixels.SetNumUninitialized(int32(TotalBytes), EAllowShrinking::No);
+	Batch.MipWrites.SetNum(LowerMips * WriteCount, EAllowShrinking::No);
+
+	// Cells are independent, each mip only reads the one above it
+	ParallelFor(WriteCount, [&](int32 i)
+	{
+		const FUpdateTextureRegion2D Cell = GetUploadRegion(Batch.Writes[i].TileIndex);
+		const uint8* Source = Batch.Writes[i].Source;
+		int32 SourcePitch = CellWidth * BytesPerPixel;
+		uint8* Dest = Batch.MipPixels.GetData() + int64(ChainBytes) * i;
+
+		for (int32 Mip = 1; Mip < NumMips; ++Mip)
+		{
+			const int32 Width = CellWidth >> Mip;
+			const int32 Height = CellHeight >> Mip;
+			const int32 Pitch = Width * BytesPerPixel;
+
+			MipDownsample::Downsample2x(Source, SourcePitch, Dest, Pitch, Width, Height, PixelFormat);
+
+			FTextureAtlasMipWrite& MipWrite = Batch.MipWrites[LowerMips * i + Mip - 1];
+			MipWrite.MipIndex = Mip;
+			MipWrite.Region = FUpdateTextureRegion2D(Cell.DestX >> Mip, Cell.DestY >> Mip, 0, 0, Width, Height);
+			MipWrite.Pitch = Pitch;
+			MipWrite.Source = Dest;
+
+			Source = Dest;
+			SourcePitch = Pitch;
+			Dest += Pitch * Height;
+		}
+	});
+}
+
+FUpdateTextureRegion2D UTextureAtlasBase::GetUploadRegion(FIntPoint TileIndex) const
+{
+	const FIntPoint Dest = GetTileDestination(TileIndex);
+	if (!IsExtrudingPadding()) return FUpdateTextureRegion2D(Dest.X, Dest.Y, 0, 0, TileWidth, TileHeight);
+
+	return FUpdateTextureRegion2D(
+		Dest.X - TilePadding, Dest.Y - TilePadding,
+		0, 0,
+		TileWidth + TilePadding * 2, TileHeight + TilePadding * 2);
+}
+
+uint32 UTextureAtlasBase::GetUploadPitch() const
+{
+	const int32 Width = IsExtrudingPadding() ? TileWidth + TilePadding * 2 : TileWidth;
+	const FPixelFormatInfo& Info = GPixelFormats[TextureFormat];
+	return (Width / Info.BlockSizeX) * Info.BlockBytes;
+}
+
+void UTextureAtlasBase::EncodeBatch(FTextureAtlasUploadBatch& Batch)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 BytesPerPixel = GPixelFormats[PixelFormat].BlockBytes;
+	const FPixelFormatInfo& Info = GPixelFormats[TextureFormat];
+	const int32 CellWidth = TileWidth + TilePadding * 2;
+	const int32 CellHeight = TileHeight + TilePadding * 2;
+
+	struct FEncodeJob
+	{
+		const uint8* Source;
+		int32 Width;
+		int32 Height;
+		int64 Offset;
+	};
+
+	// Mip 0 cells first, then the lower mip cells, packed back to back
+	blk::FFrameArenaMark Mark;
+	TArray<FEncodeJob, blk::FFrameAllocator> Jobs;
+	Jobs.Reserve(Batch.Writes.Num() + Batch.MipWrites.Num());
+
+	int64 SourceBytes = 0;
+	int64 EncodedBytes = 0;
+	auto AddJob = [&](const uint8* Source, int32 Width, int32 Height)
+	{
+		Jobs.Add({ Source, Width, Height, EncodedBytes });
+		SourceBytes += int64(Width) * Height * BytesPerPixel;
+		EncodedBytes += int64(Width / Info.BlockSizeX) * (Height / Info.BlockSizeY) * Info.BlockBytes;
+	};
+
+	for (const FTextureAtlasTileWrite& Write : Batch.Writes)
+	{
+		AddJob(Write.Source, CellWidth, CellHeight);
+	}
+	for (const FTextureAtlasMipWrite& MipWrite : Batch.MipWrites)
+	{
+		AddJob(MipWrite.Source, MipWrite.Region.Width, MipWrite.Region.Height);
+	}
+
+	// Sized once up front, so the repointed sources stay valid
+	check(EncodedBytes <= MAX_int32);
+	Batch.EncodedPixels.SetNumUninitialized(int32(EncodedBytes), EAllowShrinking::No);
+
+	ParallelFor(Jobs.Num(), [&](int32 i)
+	{
+		const FEncodeJob& Job = Jobs[i];
+		BlockCompression::Encode(
+			Compression, PixelFormat,
+			Job.Source, Job.Width * BytesPerPixel,
+			Batch.EncodedPixels.GetData() + Job.Offset,
+			Job.Width, Job.Height);
+	});
+
+	for (int32 i = 0; i < Batch.Writes.Num(); ++i)
+	{
+		Batch.Writes[i].Source = Batch.EncodedPixels.GetData() + Jobs[i].Offset;
+	}
+	for (int32 i = 0; i < Batch.MipWrites.Num(); ++i)
+	{
+		FTextureAtlasMipWrite& MipWrite = Batch.MipWrites[i];
+		MipWrite.Source = Batch.EncodedPixels.GetData() + Jobs[Batch.Writes.Num() + i].Offset;
+		MipWrite.Pitch = (MipWrite.Region.Width / Info.BlockSizeX) * Info.BlockBytes;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	FScopeLock Lock(&EncodeStatsMutex);
+	EncodeStats.EncodedCells += Jobs.Num();
+	EncodeStats.EncodedBatches += 1;
+	EncodeStats.SourceBytes += SourceBytes;
+	EncodeStats.EncodedBytes += EncodedBytes;
+	EncodeStats.TotalSeconds += Seconds;
+	EncodeStats.LastBatchSeconds = Seconds;
+	EncodeStats.MaxBatchSeconds = FMath::Max(EncodeStats.MaxBatchSeconds, Seconds);
+}
+
+FTextureAtlasEncodeStats UTextureAtlasBase::GetEncodeStats() const
+{
+	FScopeLock Lock(&EncodeStatsMutex);
+	return EncodeStats;
+}
+
+void UTextureAtlasBase::ResetEncodeStats()
+{
+	FScopeLock Lock(&EncodeStatsMutex);
+	EncodeStats = FTextureAtlasEncodeStats();
+}
+
+void UTextureAtlasBase::SubmitUploadBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch)
+{
+	FTextureResource* Resource = AtlasTexture->GetResource();
+	const uint32 Pitch = GetUploadPitch();
+
+	for (const FTextureAtlasTileWrite& Write : Batch->Writes)
+	{
+		Batch->Regions.Add(GetUploadRegion(Write.TileIndex));
+	}
+
+	ENQUEUE_RENDER_COMMAND(TextureAtlasFlushUploads)(
+		[Resource, Pitch, Batch = MoveTemp(Batch), Pool = UploadPool](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			FRHITexture* Texture = Resource->TextureRHI;
+			for (int32 i = 0; i < Batch->Writes.Num(); ++i)
+			{
+				RHICmdList.UpdateTexture2D(Texture, 0, Batch->Regions[i], Pitch, Batch->Writes[i].Source);
+			}
+
+			for (const FTextureAtlasMipWrite& MipWrite : Batch->MipWrites)
+			{
+				RHICmdList.UpdateTexture2D(Texture, MipWrite.MipIndex, MipWrite.Region, MipWrite.Pitch, MipWrite.Source);
+			}
+
+			Pool->ReleaseBatch(MoveTemp(Batch));
+		});
 }
\ No newline at end of file
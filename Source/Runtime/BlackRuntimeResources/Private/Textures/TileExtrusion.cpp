@@ -0,0 +1,108 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#include "TileExtrusion.h"
+
+namespace TileExtrusion
+{
+	namespace
+	{
+		struct FPixel128 { uint64 Lo, Hi; };
+
+		// Column replication on a fixed size pixel. A plain store loop the compiler vectorizes.
+		template <typename TPixel>
+		FORCEINLINE void Fill(uint8* Dest, const uint8* Pixel, int32 Count)
+		{
+			TPixel Value;
+			FMemory::Memcpy(&Value, Pixel, sizeof(TPixel));
+
+			TPixel* Out = reinterpret_cast<TPixel*>(Dest);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Out[i] = Value;
+			}
+		}
+
+		FORCEINLINE void FillGeneric(uint8* Dest, const uint8* Pixel, int32 Count, int32 BytesPerPixel)
+		{
+			for (int32 i = 0; i < Count; ++i)
+			{
+				FMemory::Memcpy(Dest + i * BytesPerPixel, Pixel, BytesPerPixel);
+			}
+		}
+
+		template <typename TPixel>
+		void ExtrudeRows(
+			const uint8* Source, int32 SourcePitch,
+			uint8* Dest, int32 DestPitch,
+			int32 Width, int32 Height, int32 Padding)
+		{
+			constexpr int32 Bpp = sizeof(TPixel);
+			const int32 RowBytes = Width * Bpp;
+
+			for (int32 y = 0; y < Height; ++y)
+			{
+				const uint8* In = Source + y * SourcePitch;
+				uint8* Out = Dest + (y + Padding) * DestPitch;
+
+				Fill<TPixel>(Out, In, Padding);
+				FMemory::Memcpy(Out + Padding * Bpp, In, RowBytes);
+				Fill<TPixel>(Out + (Padding + Width) * Bpp, In + RowBytes - Bpp, Padding);
+			}
+		}
+
+		void ExtrudeRowsGeneric(
+			const uint8* Source, int32 SourcePitch,
+			uint8* Dest, int32 DestPitch,
+			int32 Width, int32 Height, int32 Padding,
+			int32 Bpp)
+		{
+			const int32 RowBytes = Width * Bpp;
+
+			for (int32 y = 0; y < Height; ++y)
+			{
+				const uint8* In = Source + y * SourcePitch;
+				uint8* Out = Dest + (y + Padding) * DestPitch;
+
+				FillGeneric(Out, In, Padding, Bpp);
+				FMemory::Memcpy(Out + Padding * Bpp, In, RowBytes);
+				FillGeneric(Out + (Padding + Width) * Bpp, In + RowBytes - Bpp, Padding, Bpp);
+			}
+		}
+	}
+
+	bool SupportsFormat(EPixelFormat Format)
+	{
+		const FPixelFormatInfo& Info = GPixelFormats[Format];
+		return Info.BlockSizeX == 1 && Info.BlockSizeY == 1 && Info.BlockBytes > 0;
+	}
+
+	void ExtrudeTile(
+		const uint8* Source, int32 SourcePitch,
+		uint8* Dest,
+		int32 Width, int32 Height, int32 Padding,
+		int32 BytesPerPixel)
+	{
+		const int32 DestPitch = (Width + Padding * 2) * BytesPerPixel;
+
+		// Interior rows with their left and right gutters
+		switch (BytesPerPixel)
+		{
+		case 1:  ExtrudeRows<uint8>(Source, SourcePitch, Dest, DestPitch, Width, Height, Padding); break;
+		case 2:  ExtrudeRows<uint16>(Source, SourcePitch, Dest, DestPitch, Width, Height, Padding); break;
+		case 4:  ExtrudeRows<uint32>(Source, SourcePitch, Dest, DestPitch, Width, Height, Padding); break;
+		case 8:  ExtrudeRows<uint64>(Source, SourcePitch, Dest, DestPitch, Width, Height, Padding); break;
+		case 16: ExtrudeRows<FPixel128>(Source, SourcePitch, Dest, DestPitch, Width, Height, Padding); break;
+		default: ExtrudeRowsGeneric(Source, SourcePitch, Dest, DestPitch, Width, Height, Padding, BytesPerPixel); break;
+		}
+
+		// Top and bottom gutters replicate the finished first and last rows
+		const uint8* First = Dest + Padding * DestPitch;
+		const uint8* Last = Dest + (Padding + Height - 1) * DestPitch;
+
+		for (int32 y = 0; y < Padding; ++y)
+		{
+			FMemory::Memcpy(Dest + y * DestPitch, First, DestPitch);
+			FMemory::Memcpy(Dest + (Padding + Height + y) * DestPitch, Last, DestPitch);
+		}
+	}
+}
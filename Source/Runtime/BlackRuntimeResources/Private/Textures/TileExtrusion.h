@@ -0,0 +1,19 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace TileExtrusion
+{
+	// True if tiles of this format can be extruded pixel by pixel (not block compressed)
+	bool SupportsFormat(EPixelFormat Format);
+
+	// Copies a Width x Height tile into Dest with Padding pixels on every side, filled with the
+	// clamped edge pixels. Dest rows are (Width + 2 * Padding) pixels apart.
+	void ExtrudeTile(
+		const uint8* Source, int32 SourcePitch,
+		uint8* Dest,
+		int32 Width, int32 Height, int32 Padding,
+		int32 BytesPerPixel);
+}
@@ -2,53 +2,39 @@
 
 #pragma once
 
-#include "Templates/IntrusiveRefCounter.h"
-#include "Templates/IntrusiveRefProvider.h"
-#include "Templates/IntrusiveRefCountable.h"
-#include "Containers/IntrusiveDoubleLinkedList.h"
-#include "Containers/IndexPool.h"
 #include "Containers/IndexPool2D.h"
+#include "Containers/FrameAllocator.h"
+#include "TextureAtlasNodes.h"
 #include "TextureAtlasBase.h"
+#include "Templates/Function.h"
 #include "LRUTextureAtlas.generated.h"
 
-// A struct that represents an FIntPoint but also supports the following:
-// IntrusiveRefCounters
-//	- Allows ref counting via the RefCounters, while not destroying the FIndex on 0 ref
-//	- Allows users to hold a Provider to create more refcounter pointers and keep index alive
-// 
-// DoubleLinkedList
-//	- Allows the FIndexs to be stored in a chunked array (pointer stability)
-//	- Allows iterating via lru, by moving newly used FIndex to the tail with thread safety
-struct BLACKRUNTIMERESOURCES_API FLRUTextureAtlasIndex :
-	public TIntrusiveDoubleLinkedList<FLRUTextureAtlasIndex>::NodeType,
-	public blk::TIntrusiveRefCountable<FLRUTextureAtlasIndex>
-{
-public:
-	// Default constructor for TChunkedArray
-	FLRUTextureAtlasIndex() = default;
-
-	// Should be called after default constructor
-	void Init(ULRUTextureAtlas* atlas, int32 InNodeIndex);
-
-	// Reinitializes a freed Index
-	void Reinit(FIntPoint InValue);
+// The ref count of a tile on a ULRUTextureAtlas, used as an FIntPoint through counters. Stays
+// resident at 0 refs until evicted, see TTextureAtlasNode.
+using FLRUTextureAtlasIndex = TTextureAtlasNode<FIntPoint>;
 
-	// Frees the index
-	void Free();
+// Counters of the keyed tile cache, accumulated since the last ResetCacheStats
+USTRUCT(BlueprintType)
+struct FLRUTextureAtlasCacheStats
+{
+	GENERATED_BODY()
 
-	// Moves the node back to tail on new access
-	void OnRefIncrement();
+	// FindOrAdd calls answered by a resident tile, skipping production and upload
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 Hits = 0;
 
-	// Implicitly uses this class as FIntPoint
-	FORCEINLINE operator FIntPoint() const { return Value; }
+	// FindOrAdd calls that produced and uploaded a new tile
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 Misses = 0;
 
-	FORCEINLINE int32 GetNodeIndex() const { return NodeIndex; }
+	// Keyed tiles evicted, their keys went with them
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 Evictions = 0;
 
-private:
-	FIntPoint Value; // Index of the tile on the atlas
-	int32 NodeIndex; // Index inside the TChunkedArray
-	ULRUTextureAtlas* Atlas; // Used to move node to tail
-	bool Freed; // Mostly to make sure indices are being freed properly
+	double GetHitRate() const
+	{
+		return Hits + Misses > 0 ? double(Hits) / double(Hits + Misses) : 0.0;
+	}
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEvict, FIntPoint, Index);
@@ -63,7 +49,7 @@ public:
 
 	// Aliases
 	using Index = FLRUTextureAtlasIndex;
-	using IndexProvider = blk::TIntrusiveRefProvider<Index>;
+	using IndexHandle = blk::FSlotHandle;
 	using IndexCounter = blk::TIntrusiveRefCounter<Index>;
 
 	// --- Setup ---
@@ -77,38 +63,117 @@ public:
 		int32 InTilePadding, EPixelFormat InFormat
 	) override;
 
+	// Drops unflushed uploads, whose tile refs must not outlive the node chunks
+	virtual void BeginDestroy() override;
+
 
 	// --- Tile management ---
-	TArray<IndexProvider> GetUnusedTiles(int32 Count);
+	TArray<IndexHandle> GetUnusedTiles(int32 Count);
+
+	// Same as above without touching the heap, the handles live in the calling thread's frame
+	// arena. Returns false and adds nothing if the tiles could not be freed.
+	bool GetUnusedTiles(int32 Count, TArray<IndexHandle, blk::FFrameAllocator>& OutHandles);
+
+	// Strong ref to the tile behind Handle, null once the tile has been evicted. Lock-free.
+	IndexCounter Acquire(IndexHandle Handle) const { return Nodes.Acquire(Handle); }
+
+	// True until the tile behind Handle is evicted
+	bool IsValid(IndexHandle Handle) const { return Nodes.IsValid(Handle); }
 
 	void WriteTiles(
 		TArray<IndexCounter>& TileIndices,
 		TArray<uint8>& PixelData
 	);
 
-	TArray<IndexProvider> WriteTiles(
+	TArray<IndexHandle> WriteTiles(
 		TArray<uint8>& PixelData,
 		int32 Count
 	);
 
+	// Queues PixelData for the tiles and holds a ref on each until FlushUploads has submitted it,
+	// so none can be evicted and rewritten before the queued upload lands
+	using Super::QueueTileUpload;
+	void QueueTileUpload(
+		TArray<IndexCounter>&& Tiles,
+		TArray<uint8>&& PixelData
+	);
+
+	// --- Keyed tiles ---
+	// Resident tile holding the content for Key, or null
+	IndexCounter Find(uint64 Key);
+
+	// Resident tile holding the content for Key. On a miss, Producer fills one tile of pixels
+	// laid out as in WriteTiles, and the new tile is queued for upload on the next FlushUploads.
+	// The key is registered before Producer runs, so a concurrent call for it may get the tile
+	// before its upload is queued. Keys are user ids or content hashes, and leave the atlas with
+	// their tile. Returns null if no tile could be freed.
+	IndexCounter FindOrAdd(uint64 Key, TFunctionRef<void(TArray<uint8>& PixelData)> Producer);
+
+	UFUNCTION(BlueprintPure, Category = "TextureAtlas")
+	FLRUTextureAtlasCacheStats GetCacheStats() const;
+
+	UFUNCTION(BlueprintCallable, Category = "TextureAtlas")
+	void ResetCacheStats();
+
+	// Relinks every node queued by deferred touches. Call once per frame when bDeferTouches is set.
+	UFUNCTION(BlueprintCallable, Category = "TextureAtlas")
+	void FlushTouches();
+
+	// Frees the trailing node chunks that hold no live node. Evicted nodes are only reclaimed
+	// after their grace period, so a chunk may take a few calls to go.
+	UFUNCTION(BlueprintCallable, Category = "TextureAtlas")
+	void TrimNodes();
+
 	FOnEvict OnEvict;
 
+	// Queue ref transitions in lock free touch buffers instead of relinking under LRUMutex on
+	// every first AddRef and last Release. Must be set before Initialize.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas")
+	bool bDeferTouches = false;
+
 protected:
 	// Brings the parent's WriteTiles up so we can create "WriteTiles" with a different signature
 	using UTextureAtlasBase::WriteTiles;
 
-	// Evicts the least recently used non ref'd values by iterating backwards through the list
-	void Evict(int32 Count);
+	// Evicts exactly Count least recently released values by popping the head of the list.
+	// Returns false if fewer than Count unreferenced values exist.
+	bool Evict(int32 Count);
+
+	// Frees a single unreferenced node and its tile. Returns false if a handle revived it
+	// first. LRUMutex must be held.
+	bool EvictLocked(int32 NodeIndex);
+
+	// Drops the key and the tile of a node the nodes just retired. LRUMutex must be held.
+	void ReleaseTileLocked(int32 NodeIndex);
+
+	// Appends Count handles for new tiles to OutHandles, or nothing if they could not be freed
+	template <typename AllocatorType>
+	bool AddUnusedTiles(int32 Count, TArray<IndexHandle, AllocatorType>& OutHandles);
+
+	// Resident tile for Key, or null. LRUMutex must be held.
+	IndexCounter FindLocked(uint64 Key);
+
+	// --- Capacity hooks for derived atlases ---
+	// Number of tiles that can be resident at once
+	virtual int32 GetTileCapacity() const { return GetMaxTileCount(); }
+
+	// Called before evicting, with the number of tiles that need to be resident
+	virtual void GrowCapacity(int32 RequiredTiles) {}
+
+	// Hands out and takes back tile indices. LRUMutex is held.
+	virtual FIntPoint AcquireTileIndex() { return TileIndexPool.Acquire(); }
+	virtual void ReleaseTileIndex(FIntPoint TileIndex) { TileIndexPool.Release(TileIndex); }
 
-	friend struct FLRUTextureAtlasIndex;
-	void MoveToTail(Index* node);
+	// Called when a resident tile is reconciled as referenced or unreferenced, only when that
+	// changes. New tiles start unreferenced, and evicted ones were unreferenced. LRUMutex is held.
+	virtual void OnTileTouched(FIntPoint TileIndex, bool bReferenced) {}
 
 	blk::TIndexPool2D<FIntPoint> TileIndexPool; // Unused atlas tile indices
-	blk::TIndexPool<int32> NodeIndexPool; // Free'd TChunkArray node indices
+	TTextureAtlasNodes<FIntPoint> Nodes; // Ref counted tiles and the LRU of unreferenced ones
+	mutable FCriticalSection LRUMutex; // Mutex for the LRU to make AddRef thread safe
 
-	int32 TileCount = 0;
-	TChunkedArray<Index> Nodes; // Guarantees pointer stability for Node allocations
-	TIntrusiveDoubleLinkedList<Index> LRU; // Double linked list wrapper on Nodes
-	FCriticalSection LRUMutex; // Mutex for the LRU to make AddRef thread safe
+	TMap<uint64, IndexHandle> KeyedTiles; // Key of every keyed tile, guarded by LRUMutex
+	TMap<int32, uint64> NodeKeys; // Key of every keyed node, guarded by LRUMutex
+	FLRUTextureAtlasCacheStats CacheStats; // Guarded by LRUMutex
 };
 
@@ -0,0 +1,102 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/GuillotinePacker.h"
+#include "TextureAtlasNodes.h"
+#include "TextureAtlasBase.h"
+#include "PackedTextureAtlas.generated.h"
+
+// A variable size rect on a UPackedTextureAtlas, used as an FIntRect through counters. Ref
+// counted, handled and evicted like FLRUTextureAtlasIndex, see TTextureAtlasNode. The rect
+// excludes the padding.
+using FPackedTextureAtlasRect = TTextureAtlasNode<FIntRect>;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnEvictRect, FIntPoint, Min, FIntPoint, Max);
+
+
+// Atlas that packs rects of any size with a guillotine packer instead of a fixed tile grid.
+// TilePadding is reserved around every rect.
+UCLASS(BlueprintType)
+class BLACKRUNTIMERESOURCES_API UPackedTextureAtlas : public UTextureAtlasBase
+{
+	GENERATED_BODY()
+
+public:
+
+	// Aliases
+	using Rect = FPackedTextureAtlasRect;
+	using RectHandle = blk::FSlotHandle;
+	using RectCounter = blk::TIntrusiveRefCounter<Rect>;
+
+	// --- Setup ---
+	UFUNCTION(
+		BlueprintCallable,
+		Category = "TextureAtlas",
+		meta = (DisplayName = "Initialize Packed Atlas"))
+	void InitializePacked(
+		int32 InAtlasWidth, int32 InAtlasHeight,
+		int32 InTilePadding, EPixelFormat InFormat
+	);
+
+	// Tile sizes have no meaning here, so this forwards to InitializePacked
+	virtual void Initialize(
+		int32 InAtlasWidth, int32 InAtlasHeight,
+		int32 InTileWidth, int32 InTileHeight,
+		int32 InTilePadding, EPixelFormat InFormat
+	) override;
+
+	// --- Rect management ---
+	// Allocates a Size rect, evicting unreferenced rects if needed. Returns a null handle when
+	// the rect cannot fit even after evicting everything unreferenced.
+	RectHandle Allocate(FIntPoint Size);
+
+	// Strong ref to the rect behind Handle, null once the rect has been freed or evicted. Lock-free.
+	RectCounter Acquire(RectHandle Handle) const { return Nodes.Acquire(Handle); }
+
+	// True until the rect behind Handle is freed or evicted
+	bool IsValid(RectHandle Handle) const { return Nodes.IsValid(Handle); }
+
+	// Returns the rect to the packer right away. Fails if it is still referenced, or if the
+	// handle is stale.
+	bool Free(RectHandle Handle);
+
+	// Returns every unreferenced rect to the packer
+	void FreeUnused();
+
+	// Pixel data holds each rect's rows back to back, tightly packed, in array order. Every rect
+	// goes in one upload batch, PixelData must stay alive until the render thread has uploaded it.
+	void WriteRects(
+		TArray<RectCounter>& Rects,
+		TArray<uint8>& PixelData
+	);
+
+	// --- Rect Info ---
+	FVector2D GetRectUVOffset(const FIntRect& InRect) const;
+	FVector2D GetRectUVSize(const FIntRect& InRect) const;
+
+	// 0 when the free space is one rect, approaching 1 as it splinters
+	UFUNCTION(BlueprintPure, Category = "TextureAtlas")
+	float GetFragmentation() const;
+
+	// Fraction of the atlas covered by allocated rects, padding included
+	UFUNCTION(BlueprintPure, Category = "TextureAtlas")
+	float GetOccupancy() const;
+
+	FOnEvictRect OnEvict;
+
+protected:
+	// Uploads the regions and pitches WriteRects filled in, in a single render command
+	virtual void SubmitUploadBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch) override;
+
+	// Frees a single unreferenced node and its space. Returns false if a handle revived it
+	// first. LRUMutex must be held.
+	bool FreeLocked(int32 NodeIndex, bool bBroadcast);
+
+	// Returns the space of a node the nodes just retired. LRUMutex must be held.
+	void ReleaseRectLocked(int32 NodeIndex, bool bBroadcast);
+
+	blk::FGuillotinePacker Packer;
+	TTextureAtlasNodes<FIntRect> Nodes; // Ref counted rects and the LRU of unreferenced ones
+	mutable FCriticalSection LRUMutex; // Guards the packer and the nodes
+};
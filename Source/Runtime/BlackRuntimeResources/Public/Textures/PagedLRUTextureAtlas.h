@@ -0,0 +1,104 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/IndexPool2D.h"
+#include "Math/GridShape.h"
+#include "LRUTextureAtlas.h"
+#include "PagedLRUTextureAtlas.generated.h"
+
+class UTexture2DArray;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPagesResized, UTexture2DArray*, Texture);
+
+// An LRU atlas whose tiles live on the slices of a texture array. Pages are added when the
+// resident tile count grows past GrowThreshold, and trailing pages whose tiles have been
+// unreferenced for PageReleaseCooldown seconds are released by TrimPages.
+//
+// Paged tile indices are stored in the LRU as FIntPoint(X, Page * TilesPerColumn + Y), so
+// handles, counters and OnEvict keep working unchanged. Use GetPagedTileIndex or
+// GetPagedTileUVOffset to split them back into a slice and a position.
+//
+// There is no 2D atlas texture, GetAtlasTexture returns null. Each upload batch is staged on the
+// render thread through a transient texture covering only the batch's dirty region, and then
+// copied into its slices.
+UCLASS(BlueprintType)
+class BLACKRUNTIMERESOURCES_API UPagedLRUTextureAtlas : public ULRUTextureAtlas
+{
+	GENERATED_BODY()
+
+public:
+	// --- Setup ---
+	virtual void Initialize(
+		int32 InAtlasWidth, int32 InAtlasHeight,
+		int32 InTileWidth, int32 InTileHeight,
+		int32 InTilePadding, EPixelFormat InFormat
+	) override;
+
+	// --- Blueprint Accessors ---
+	// Splits a paged tile index into (X, Y, Page)
+	UFUNCTION(BlueprintPure, Category = "TextureAtlas")
+	FIntVector GetPagedTileIndex(FIntPoint TileIndex) const;
+
+	// Returns (U, V, Slice) for a paged tile index
+	UFUNCTION(BlueprintPure, Category = "TextureAtlas")
+	FVector GetPagedTileUVOffset(FIntPoint TileIndex) const;
+
+	// Releases trailing pages that have had no referenced tiles for PageReleaseCooldown seconds.
+	// Their resident tiles are evicted first. Call periodically, e.g. once per frame.
+	UFUNCTION(BlueprintCallable, Category = "TextureAtlas")
+	void TrimPages();
+
+	// --- Page Info ---
+	FORCEINLINE int32 GetPageCount() const { return Pages.Num(); }
+	FORCEINLINE UTexture2DArray* GetAtlasTextureArray() const { return AtlasTextureArray; }
+
+	// Broadcast with the new texture array whenever pages are added or released
+	FOnPagesResized OnPagesResized;
+
+	// --- Paging Policy (set before Initialize) ---
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas")
+	int32 MaxPageCount = 8;
+
+	// Fraction of the current capacity the resident tiles may reach before a page is added
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas")
+	float GrowThreshold = 0.9f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas")
+	float PageReleaseCooldown = 5.f;
+
+protected:
+	// Creates the first page instead of a 2D texture
+	virtual void CreateAtlasTexture() override;
+
+	// --- Tile management ---
+	// Checks the page and the position on it
+	virtual bool IsValidTileIndex(FIntPoint TileIndex) const override;
+
+	virtual void SubmitUploadBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch) override;
+
+	// --- Capacity hooks ---
+	virtual int32 GetTileCapacity() const override;
+	virtual void GrowCapacity(int32 RequiredTiles) override;
+	virtual FIntPoint AcquireTileIndex() override;
+	virtual void ReleaseTileIndex(FIntPoint TileIndex) override;
+	virtual void OnTileTouched(FIntPoint TileIndex, bool bReferenced) override;
+
+	// Recreates the texture array with PageCount slices, copying the surviving slices
+	void ResizePages(int32 PageCount);
+
+	struct FPage
+	{
+		blk::TIndexPool2D<FIntPoint> TilePool; // Unused tile indices on this page
+		int32 ResidentTiles = 0;
+		int32 ReferencedTiles = 0; // Resident tiles reconciled as referenced, so off the LRU
+		double IdleSince = 0.0; // Last ref transition on one of its tiles, or TrimPages seeing one referenced
+	};
+
+	TArray<FPage> Pages;
+	int32 TilesPerColumn = 0;
+	blk::FGridDivisor PageDivisor; // Splits a paged Y into its page and row
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	UTexture2DArray* AtlasTextureArray = nullptr;
+};
@@ -5,8 +5,120 @@
 #include "PixelFormat.h"
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Containers/Queue.h"
+#include "Containers/ConcurrentObjectPool.h"
+#include "RHI.h"
 #include "TextureAtlasBase.generated.h"
 
+// Block compressed storage for the atlas texture. Tiles are still written in the source pixel
+// format and encoded before upload.
+UENUM(BlueprintType)
+enum class ETextureAtlasCompression : uint8
+{
+	None,
+	BC1 UMETA(DisplayName = "BC1 (RGB)"),         // From 8 bit RGBA, alpha is dropped
+	BC4 UMETA(DisplayName = "BC4 (Single Channel)") // From the red channel, or a single 8 bit channel
+};
+
+// Cost of the block compression stage, accumulated since the last ResetEncodeStats
+USTRUCT(BlueprintType)
+struct FTextureAtlasEncodeStats
+{
+	GENERATED_BODY()
+
+	// Tile cells encoded, lower mips included
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 EncodedCells = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 EncodedBatches = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 SourceBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	int64 EncodedBytes = 0;
+
+	// Wall time from the start to the end of encoding each batch
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	double TotalSeconds = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	double LastBatchSeconds = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "TextureAtlas")
+	double MaxBatchSeconds = 0.0;
+
+	// Source megabytes encoded per second of wall time
+	double GetThroughputMBps() const
+	{
+		return TotalSeconds > 0.0 ? double(SourceBytes) / (1024.0 * 1024.0) / TotalSeconds : 0.0;
+	}
+
+	double GetAverageBatchSeconds() const
+	{
+		return EncodedBatches > 0 ? TotalSeconds / double(EncodedBatches) : 0.0;
+	}
+};
+
+// A single tile of a queued upload. Source points at the tile's first row, rows are
+// TileWidth pixels apart.
+struct FTextureAtlasTileWrite
+{
+	FIntPoint TileIndex;
+	const uint8* Source = nullptr;
+};
+
+// A downsampled tile cell for one of the lower mips, uploaded alongside mip 0
+struct FTextureAtlasMipWrite
+{
+	int32 MipIndex = 0;
+	FUpdateTextureRegion2D Region;
+	uint32 Pitch = 0;
+	const uint8* Source = nullptr;
+};
+
+// Everything one FlushUploads hands to the render thread. Owns or shares every pixel buffer its
+// writes point into, so nothing is copied and nothing dies before the render thread is done.
+struct FTextureAtlasUploadBatch
+{
+	TArray<TArray<uint8>> OwnedBuffers;
+	TArray<TSharedRef<const TArray<uint8>, ESPMode::ThreadSafe>> SharedBuffers;
+	TArray<FTextureAtlasTileWrite> Writes;
+	TArray<FUpdateTextureRegion2D> Regions; // One per write, filled by SubmitUploadBatch
+	TArray<int32> Slices; // Texture array slice of each write, filled by paged atlases
+	TArray<uint32> Pitches; // Source pitch of each write, filled by packed atlases whose writes differ in size
+	TArray<uint8> ExtrudedPixels; // Padded copies of the writes when extruding padding
+	TArray<FTextureAtlasMipWrite> MipWrites; // Lower mips of the writes, filled by BuildMips
+	TArray<uint8> MipPixels;
+	TArray<uint8> EncodedPixels; // Block compressed writes and mip writes when compressing
+
+	// Drops the buffers and writes but keeps every array's allocation
+	void Reset();
+};
+
+// Recycled upload buffers and batches, shared with the render thread so they can be returned
+// after the atlas itself is gone
+struct FTextureAtlasUploadPool
+{
+	TArray<uint8> AcquireBuffer();
+	void ReleaseBuffer(TArray<uint8>&& Buffer);
+
+	TUniquePtr<FTextureAtlasUploadBatch> AcquireBatch();
+	void ReleaseBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch);
+
+	// Buffers beyond this count are freed instead of recycled
+	int32 MaxPooledBuffers = 64;
+
+private:
+	// Batches come back from the render thread while the game thread takes new ones, so they go
+	// through a lock-free pool. Buffers are handed out by value and keep the lock.
+	blk::TConcurrentObjectPool<FTextureAtlasUploadBatch> Batches{ 16 };
+
+	FCriticalSection Mutex;
+	TArray<TArray<uint8>> FreeBuffers;
+};
+
 UCLASS(BlueprintType, Abstract)
 class BLACKRUNTIMERESOURCES_API UTextureAtlasBase : public UObject
 {
@@ -28,7 +140,7 @@ public:
 	inline FVector2D GetTileUVOffset(FIntPoint TileIndex) const;
 
 	// --- Atlas Info ---
-	FORCEINLINE bool IsInitialized() const { return AtlasTexture != nullptr; }
+	FORCEINLINE bool IsInitialized() const { return bInitialized; }
 	FORCEINLINE int32 GetAtlasWidth() const { return AtlasWidth; }
 	FORCEINLINE int32 GetAtlasHeight() const { return AtlasHeight; }
 
@@ -37,6 +149,8 @@ public:
 	FORCEINLINE int32 GetTileHeight() const { return TileHeight; }
 	FORCEINLINE int32 GetTilePadding() const { return TilePadding; }
 	FORCEINLINE EPixelFormat GetPixelFormat() const { return PixelFormat; }
+	FORCEINLINE EPixelFormat GetTextureFormat() const { return TextureFormat; }
+	FORCEINLINE bool IsCompressing() const { return TextureFormat != PixelFormat; }
 	FORCEINLINE UTexture2D* GetAtlasTexture() const { return AtlasTexture; }
 
 	// --- Derived Info ---
@@ -44,8 +158,67 @@ public:
 	FORCEINLINE int32 GetMaxTileIndexY() const { return MaxTileIndexY; }
 	FORCEINLINE int32 GetMaxTileCount() const { return MaxTileCount; }
 
+	// --- Async Uploads (any thread) ---
+	// Returns an empty buffer that keeps the allocation of a previously uploaded one
+	TArray<uint8> AcquireUploadBuffer();
+
+	// Takes ownership of the pixel data. Tiles are laid out as in WriteTiles. Nothing keeps the
+	// tiles themselves until FlushUploads: atlases that reuse tiles must hold them until then,
+	// through KeepAlive for instance, which is dropped once the upload has been submitted.
+	void QueueTileUpload(
+		TArray<FIntPoint>&& TileIndices,
+		TArray<uint8>&& PixelData,
+		TSharedPtr<void, ESPMode::ThreadSafe> KeepAlive = nullptr
+	);
+
+	// Shares the pixel data. It is released once the render thread has uploaded it.
+	void QueueTileUpload(
+		TArray<FIntPoint>&& TileIndices,
+		const TSharedRef<const TArray<uint8>, ESPMode::ThreadSafe>& PixelData,
+		TSharedPtr<void, ESPMode::ThreadSafe> KeepAlive = nullptr
+	);
+
+	// Submits every queued upload in a single render command. Call once per frame.
+	UFUNCTION(BlueprintCallable, Category = "TextureAtlas")
+	void FlushUploads();
+
+	// Fill TilePadding with the clamped edge pixels of each tile during upload, so linear
+	// filtering does not bleed between tiles. Must be set before Initialize. Not supported for
+	// block compressed formats.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas")
+	bool bExtrudePadding = false;
+
+	bool IsExtrudingPadding() const;
+
+	// Mip levels of the atlas texture. Written tiles are downsampled into the lower mips with a
+	// box filter, so only the tiles of each batch are touched. Must be set before Initialize.
+	// Padding is always extruded in this mode, and the count is clamped so every tile cell
+	// (TileWidth + 2 * TilePadding) stays pixel aligned down to the smallest mip.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas", meta = (ClampMin = "1"))
+	int32 MipCount = 1;
+
+	FORCEINLINE int32 GetNumMips() const { return NumMips; }
+
+	// Stores the atlas block compressed, encoding each batch on task graph workers. Must be set
+	// before Initialize. Padding is grown until tile cells are whole 4x4 blocks and is always
+	// extruded; tile sizes must be even. Falls back to uncompressed if the pixel format can not
+	// be encoded.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TextureAtlas")
+	ETextureAtlasCompression Compression = ETextureAtlasCompression::None;
+
+	UFUNCTION(BlueprintPure, Category = "TextureAtlas")
+	FTextureAtlasEncodeStats GetEncodeStats() const;
+
+	UFUNCTION(BlueprintCallable, Category = "TextureAtlas")
+	void ResetEncodeStats();
 
 protected:
+	// Creates the transient atlas texture from AtlasWidth, AtlasHeight and PixelFormat
+	virtual void CreateAtlasTexture();
+
+	// Turns bExtrudePadding off for formats it can not be done in
+	void ResolveExtrusion();
+
 	// --- Tile management ---
 	virtual void WriteTile(
 		FIntPoint Index,
@@ -53,10 +226,50 @@ protected:
 	);
 
 	virtual void WriteTiles(
-		TArray<FIntPoint>& TileIndices,
+		TArrayView<const FIntPoint> TileIndices,
 		TArray<uint8>& PixelData
 	);
 
+	// True if TileIndex addresses a tile cell of the atlas. Checked on every queued or written
+	// tile, atlases that encode more than a cell position in their indices check the cell part.
+	virtual bool IsValidTileIndex(FIntPoint TileIndex) const;
+
+	// Extrudes the batch if needed and hands it to SubmitUploadBatch
+	void SubmitUploads(TUniquePtr<FTextureAtlasUploadBatch>&& Batch);
+
+	// Repoints every write at a padded copy with extruded edges
+	void ExtrudeBatch(FTextureAtlasUploadBatch& Batch);
+
+	// Downsamples every written tile cell into the lower mips
+	void BuildMips(FTextureAtlasUploadBatch& Batch);
+
+	// Encodes every write and mip write in place of its source pixels
+	void EncodeBatch(FTextureAtlasUploadBatch& Batch);
+
+	// Compressed format for Compression, aligning TilePadding and the atlas size to its blocks.
+	// PixelFormat if not compressing.
+	EPixelFormat ResolveTextureFormat();
+
+	// Largest mip count up to MipCount that keeps the tile cells aligned, 1 if unsupported
+	int32 ResolveMipCount() const;
+
+	// Region and source pitch of a single tile write, gutters included when extruding. The pitch
+	// is in blocks of the texture format once encoded.
+	FUpdateTextureRegion2D GetUploadRegion(FIntPoint TileIndex) const;
+	uint32 GetUploadPitch() const;
+
+	// Enqueues the render command for a flushed batch. The batch goes back to UploadPool once
+	// the render thread is done with it.
+	virtual void SubmitUploadBatch(TUniquePtr<FTextureAtlasUploadBatch>&& Batch);
+
+	// Top left pixel of a tile's interior
+	FORCEINLINE FIntPoint GetTileDestination(FIntPoint TileIndex) const
+	{
+		return FIntPoint(
+			(TilePadding * 2 + TileWidth) * TileIndex.X + TilePadding,
+			(TilePadding * 2 + TileHeight) * TileIndex.Y + TilePadding);
+	}
+
 	// --- Atlas Properties ---
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	int32 AtlasWidth = 0;
@@ -80,12 +293,31 @@ protected:
 	UTexture2D* AtlasTexture = nullptr;
 
 	// --- Derived Cache (not exposed) ---
+	bool bInitialized = false;
 	int32 MaxTileIndexX = 0;
 	int32 MaxTileIndexY = 0;
 	int32 MaxTileCount = 0;
+	int32 NumMips = 1;
+	EPixelFormat TextureFormat = PF_Unknown;
 
 	float TileUVStepX = 0.f;
 	float TileUVStepY = 0.f;
 	float PaddingUVStepX = 0.f;
 	float PaddingUVStepY = 0.f;
+
+	// --- Async Uploads ---
+	struct FQueuedTileUpload
+	{
+		TArray<FIntPoint> TileIndices;
+		TArray<uint8> OwnedPixels;
+		TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> SharedPixels;
+		TSharedPtr<void, ESPMode::ThreadSafe> KeepAlive;
+	};
+
+	TQueue<FQueuedTileUpload, EQueueMode::Mpsc> QueuedUploads;
+	TSharedRef<FTextureAtlasUploadPool, ESPMode::ThreadSafe> UploadPool =
+		MakeShared<FTextureAtlasUploadPool, ESPMode::ThreadSafe>();
+
+	mutable FCriticalSection EncodeStatsMutex;
+	FTextureAtlasEncodeStats EncodeStats;
 };
\ No newline at end of file
@@ -0,0 +1,500 @@
+// Copyright (c) Black Megacorp. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/IntrusiveRefCounter.h"
+#include "Templates/IntrusiveRefCountable.h"
+#include "Templates/IntrusiveRefTable.h"
+#include "Templates/Function.h"
+#include "Templates/UniquePtr.h"
+#include "Containers/BitIndexPool.h"
+#include "Containers/ConcurrentRingQueue.h"
+#include "Containers/EpochDomain.h"
+#include "Containers/SlotMap.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/PlatformMisc.h"
+#include <atomic>
+
+template <typename ValueType> struct TTextureAtlasNodeChunk;
+template <typename ValueType> class TTextureAtlasNodes;
+
+// The ref count of a value resident on an atlas, a tile index or a packed rect, used as that
+// value through counters:
+// IntrusiveRefCounters
+//	- Allows ref counting via the RefCounters, while not destroying the node on 0 ref
+//	- Allows users to hold an 8 byte FSlotHandle to create more refcounter pointers and keep the
+//	  value alive. Handles carry a generation checked against the nodes' handle table, so they
+//	  never point into node storage.
+//	- Handles upgrade without the atlas lock. Eviction retires the node first, so an upgrade
+//	  either wins or fails, and the node is only reused after an epoch grace period.
+//
+// Node chunks
+//	- The count is all the node holds. The value, the LRU links and the flags of each node sit
+//	  in arrays next to it in a TTextureAtlasNodeChunk, so eviction scans and relinks walk a few
+//	  dense arrays instead of scattered nodes.
+//	- Chunks never move (pointer stability). Trailing chunks are freed by TrimLocked once no
+//	  live node is left in them.
+//	- Only unreferenced nodes are linked, by int32 node index. The first AddRef unlinks the node
+//	  and the last Release links it back at the tail, so the head is always the next eviction
+//	  candidate.
+//
+// Deferred touches
+//	- When touches are deferred, the first AddRef and last Release only flag the node and
+//	  queue it in a lock free touch buffer. Queued nodes are relinked in a batch on
+//	  FlushTouchesLocked.
+template <typename ValueType>
+struct TTextureAtlasNode :
+	public blk::TIntrusiveRefCountable<
+		TTextureAtlasNode<ValueType>,
+		blk::ERefCountThreading::SequentiallyConsistent,
+		blk::ERefCountHooks::OnFirstRef,
+		blk::ERefCountWeakRefs::None>
+{
+public:
+	// Default constructor for the node chunks
+	TTextureAtlasNode() = default;
+
+	// Takes the node off the eviction list while it is referenced
+	void OnFirstRef();
+
+	// Puts the node back at the tail of the eviction list once unreferenced
+	void OnLastRelease();
+
+	// Implicitly uses this class as its value
+	FORCEINLINE operator ValueType() const { return GetValue(); }
+
+	ValueType GetValue() const;
+	int32 GetNodeIndex() const;
+	bool IsFreed() const;
+
+private:
+	// Counts come first in their chunk, which is aligned to their size
+	TTextureAtlasNodeChunk<ValueType>& GetChunk() const;
+};
+
+// Metadata of NodeCount consecutive nodes, one array per field
+template <typename ValueType>
+struct alignas(64 * sizeof(TTextureAtlasNode<ValueType>)) TTextureAtlasNodeChunk
+{
+	static constexpr int32 NodeCount = 64;
+
+	TTextureAtlasNodeChunk(TTextureAtlasNodes<ValueType>* InOwner, int32 InFirstNodeIndex);
+
+	TTextureAtlasNode<ValueType> RefCounts[NodeCount];
+	ValueType Values[NodeCount]; // What the node holds on the atlas
+	int32 Prev[NodeCount]; // LRU links by node index, INDEX_NONE at the ends
+	int32 Next[NodeCount];
+	bool Freed[NodeCount]; // Mostly to make sure nodes are being freed properly
+	std::atomic<bool> TouchPending[NodeCount]; // Set while the node sits in a touch buffer
+
+	TTextureAtlasNodes<ValueType>* Owner; // Used to link and unlink the nodes
+	int32 FirstNodeIndex;
+};
+
+// Node indices queued by deferred touches. Any thread pushes, the thread holding the mutex drains.
+using FTextureAtlasTouchBuffer = blk::TConcurrentRingQueue<int32>;
+
+// Storage and lifecycle of the ref counted nodes of an atlas: chunked node storage, handles,
+// the LRU of unreferenced nodes, deferred touches, and retiring and reclaiming nodes. The atlas
+// owns the mutex and what the values stand for, and frees a value's space once its node is
+// retired.
+//
+// Locked calls expect the atlas' mutex to be held, Acquire and IsValid are lock-free.
+template <typename ValueType>
+class TTextureAtlasNodes
+{
+public:
+	using NodeType = TTextureAtlasNode<ValueType>;
+	using ChunkType = TTextureAtlasNodeChunk<ValueType>;
+	using CounterType = blk::TIntrusiveRefCounter<NodeType>;
+
+	// Called under the mutex when a live node is reconciled as referenced or unreferenced, only
+	// when that changes. New nodes start unreferenced, and retired ones were unreferenced.
+	using FOnTouched = TFunction<void(const ValueType& Value, bool bReferenced)>;
+
+	// Called from the atlas' Initialize, before the first node is added. A TouchCapacity above 0
+	// defers touches into per thread shards of that many nodes.
+	void Init(FCriticalSection& InMutex, int32 TouchCapacity = 0, FOnTouched&& InOnTouched = nullptr);
+
+	// Strong ref to the node behind Handle, null once it has been retired. Lock-free.
+	CounterType Acquire(blk::FSlotHandle Handle) const { return Handles.Acquire(Handle); }
+
+	// True until the node behind Handle is retired
+	bool IsValid(blk::FSlotHandle Handle) const { return Handles.IsValid(Handle); }
+
+	// Live nodes, retired ones excluded
+	FORCEINLINE int32 Num() const { return LiveCount; }
+
+	// True if ref transitions are queued until FlushTouchesLocked
+	FORCEINLINE bool IsDeferringTouches() const { return !TouchBuffers.IsEmpty(); }
+
+	// Adds an unreferenced node holding Value at the tail of the LRU
+	blk::FSlotHandle AddLocked(const ValueType& Value);
+
+	// Brings back the nodes past their grace period. Called before a batch of AddLocked.
+	void ReclaimLocked();
+
+	// Retires a single unreferenced node. Returns false if a handle revived it first. The value
+	// stays readable until the node is reclaimed.
+	bool RetireLocked(int32 NodeIndex);
+
+	// Retires the least recently released node and returns its index, or INDEX_NONE once the
+	// LRU is empty. Heads referenced after their last touch are skipped, their pending touch
+	// settles them.
+	int32 RetireHeadLocked();
+
+	// Drains all touch buffers into the LRU
+	void FlushTouchesLocked();
+
+	// Reclaims nodes past their grace period and frees the chunks above the highest live node
+	void TrimLocked();
+
+	// Index linked LRU of unreferenced nodes, least recently released at head
+	FORCEINLINE int32 GetHeadLocked() const { return LRUHead; }
+	FORCEINLINE int32 GetNextLocked(int32 NodeIndex) const { return GetChunk(NodeIndex).Next[GetSlot(NodeIndex)]; }
+
+	// Node storage. NodeIndex must be below the chunked node count.
+	FORCEINLINE ChunkType& GetChunk(int32 NodeIndex) const
+	{
+		return *NodeChunks[NodeIndex / ChunkType::NodeCount];
+	}
+
+	FORCEINLINE static int32 GetSlot(int32 NodeIndex)
+	{
+		return NodeIndex % ChunkType::NodeCount;
+	}
+
+	FORCEINLINE NodeType& GetNode(int32 NodeIndex) const
+	{
+		return GetChunk(NodeIndex).RefCounts[GetSlot(NodeIndex)];
+	}
+
+	FORCEINLINE const ValueType& GetValue(int32 NodeIndex) const
+	{
+		return GetChunk(NodeIndex).Values[GetSlot(NodeIndex)];
+	}
+
+protected:
+	friend struct TTextureAtlasNode<ValueType>;
+
+	// Links or unlinks the node after a ref transition, either now or deferred
+	void Touch(ChunkType& Chunk, int32 Slot);
+
+	// Queues the node in the calling thread's touch buffer
+	void DeferTouch(ChunkType& Chunk, int32 Slot);
+
+	// Brings the node's list membership in line with its ref count
+	void ReconcileLocked(int32 NodeIndex);
+
+	// Index linked list over the chunk arrays
+	bool IsLinkedLocked(int32 NodeIndex) const;
+	void LinkTailLocked(int32 NodeIndex);
+	void UnlinkLocked(int32 NodeIndex);
+
+	blk::TBitIndexPool<int32> NodeIndexPool; // Live node indices, kept dense at the bottom
+	blk::TEpochRetireList<int32> RetiredNodes; // Retired node indices waiting out their grace period
+	blk::TIntrusiveRefTable<NodeType> Handles; // Node index and generation behind every handle
+
+	int32 LiveCount = 0;
+	TArray<TUniquePtr<ChunkType>> NodeChunks; // Fixed size chunks, so nodes never move
+	int32 LRUHead = INDEX_NONE; // Unreferenced nodes, least recently released at head
+	int32 LRUTail = INDEX_NONE;
+	FCriticalSection* Mutex = nullptr; // The atlas' mutex, taken by touches
+	FOnTouched OnTouched;
+	TArray<FTextureAtlasTouchBuffer> TouchBuffers; // Sharded by thread id when touches are deferred
+	uint32 TouchShift = 32;
+};
+
+template <typename ValueType>
+FORCEINLINE TTextureAtlasNodeChunk<ValueType>& TTextureAtlasNode<ValueType>::GetChunk() const
+{
+	static_assert(sizeof(TTextureAtlasNode) * TTextureAtlasNodeChunk<ValueType>::NodeCount == alignof(TTextureAtlasNodeChunk<ValueType>),
+		"Ref counts must fill the first aligned block of their chunk");
+
+	constexpr UPTRINT Mask = alignof(TTextureAtlasNodeChunk<ValueType>) - 1;
+	return *reinterpret_cast<TTextureAtlasNodeChunk<ValueType>*>(reinterpret_cast<UPTRINT>(this) & ~Mask);
+}
+
+template <typename ValueType>
+FORCEINLINE ValueType TTextureAtlasNode<ValueType>::GetValue() const
+{
+	const TTextureAtlasNodeChunk<ValueType>& Chunk = GetChunk();
+	return Chunk.Values[this - Chunk.RefCounts];
+}
+
+template <typename ValueType>
+FORCEINLINE int32 TTextureAtlasNode<ValueType>::GetNodeIndex() const
+{
+	const TTextureAtlasNodeChunk<ValueType>& Chunk = GetChunk();
+	return Chunk.FirstNodeIndex + int32(this - Chunk.RefCounts);
+}
+
+template <typename ValueType>
+FORCEINLINE bool TTextureAtlasNode<ValueType>::IsFreed() const
+{
+	const TTextureAtlasNodeChunk<ValueType>& Chunk = GetChunk();
+	return Chunk.Freed[this - Chunk.RefCounts];
+}
+
+template <typename ValueType>
+void TTextureAtlasNode<ValueType>::OnFirstRef()
+{
+	TTextureAtlasNodeChunk<ValueType>& Chunk = GetChunk();
+	Chunk.Owner->Touch(Chunk, int32(this - Chunk.RefCounts));
+}
+
+template <typename ValueType>
+void TTextureAtlasNode<ValueType>::OnLastRelease()
+{
+	TTextureAtlasNodeChunk<ValueType>& Chunk = GetChunk();
+	Chunk.Owner->Touch(Chunk, int32(this - Chunk.RefCounts));
+}
+
+template <typename ValueType>
+TTextureAtlasNodeChunk<ValueType>::TTextureAtlasNodeChunk(
+	TTextureAtlasNodes<ValueType>* InOwner,
+	int32 InFirstNodeIndex
+)
+	: Owner(InOwner)
+	, FirstNodeIndex(InFirstNodeIndex)
+{
+	for (int32 i = 0; i < NodeCount; ++i)
+	{
+		Values[i] = ValueType();
+		Prev[i] = INDEX_NONE;
+		Next[i] = INDEX_NONE;
+		Freed[i] = true;
+		TouchPending[i].store(false, std::memory_order_relaxed);
+	}
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::Init(FCriticalSection& InMutex, int32 TouchCapacity, FOnTouched&& InOnTouched)
+{
+	Mutex = &InMutex;
+	OnTouched = MoveTemp(InOnTouched);
+
+	TouchBuffers.Empty();
+	TouchShift = 32;
+	if (TouchCapacity > 0)
+	{
+		const int32 ShardCount = FMath::Clamp(
+			int32(FMath::RoundUpToPowerOfTwo(FPlatformMisc::NumberOfCoresIncludingHyperthreads())), 1, 16);
+
+		TouchBuffers.SetNum(ShardCount);
+		TouchShift = 32 - FMath::FloorLog2(ShardCount);
+		for (FTextureAtlasTouchBuffer& Buffer : TouchBuffers)
+		{
+			Buffer.Reserve(TouchCapacity);
+		}
+	}
+}
+
+template <typename ValueType>
+blk::FSlotHandle TTextureAtlasNodes<ValueType>::AddLocked(const ValueType& Value)
+{
+	check(Mutex);
+	const int32 NodeIndex = NodeIndexPool.Acquire();
+
+	// Adds a chunk of freed nodes if needed
+	if (NodeIndex == NodeChunks.Num() * ChunkType::NodeCount)
+	{
+		NodeChunks.Add(MakeUnique<ChunkType>(this, NodeIndex));
+	}
+
+	// Sets the new value of a freed node
+	ChunkType& Chunk = GetChunk(NodeIndex);
+	const int32 Slot = GetSlot(NodeIndex);
+	check(Chunk.Freed[Slot]);
+
+	NodeType* Node = &Chunk.RefCounts[Slot];
+	Node->Reset();
+	Chunk.Values[Slot] = Value;
+	Chunk.Freed[Slot] = false;
+
+	// Unreferenced until acquired, so it starts at the tail of the eviction list
+	LinkTailLocked(NodeIndex);
+
+	++LiveCount;
+	return Handles.Add(uint32(NodeIndex), Node);
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::ReclaimLocked()
+{
+	// Retired nodes come back once no handle can still be upgrading them
+	RetiredNodes.Reclaim([this](int32 NodeIndex) { NodeIndexPool.Release(NodeIndex); });
+}
+
+template <typename ValueType>
+bool TTextureAtlasNodes<ValueType>::RetireLocked(int32 NodeIndex)
+{
+	ChunkType& Chunk = GetChunk(NodeIndex);
+	const int32 Slot = GetSlot(NodeIndex);
+	check(!Chunk.Freed[Slot]);
+
+	// Handles upgrade without the lock, so the count is only trusted once retired
+	if (!Chunk.RefCounts[Slot].TryRetire()) return false;
+	Handles.Remove(uint32(NodeIndex));
+
+	// The node waits until no upgrade can still reach it
+	UnlinkLocked(NodeIndex);
+	Chunk.Freed[Slot] = true;
+	RetiredNodes.Retire(NodeIndex);
+
+	--LiveCount;
+	return true;
+}
+
+template <typename ValueType>
+int32 TTextureAtlasNodes<ValueType>::RetireHeadLocked()
+{
+	// Head is the least recently released node. Referenced nodes are not in the list.
+	while (LRUHead != INDEX_NONE)
+	{
+		const int32 NodeIndex = LRUHead;
+		UnlinkLocked(NodeIndex);
+		if (RetireLocked(NodeIndex)) return NodeIndex;
+
+		// Referenced after its last touch was queued; its pending touch will settle it. It is
+		// unlinked from here on, so it counts as referenced until then.
+		if (OnTouched) OnTouched(GetValue(NodeIndex), true);
+	}
+
+	return INDEX_NONE;
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::TrimLocked()
+{
+	// Reclaimed first: a node only comes back once every guard that could still queue a touch
+	// for it has ended, so the flush after it drains the last mention of the chunks about to go
+	ReclaimLocked();
+	FlushTouchesLocked();
+
+	// Nodes are handed out lowest index first, so live ones sit at the bottom. Retired nodes still
+	// count as live until reclaimed, which keeps their chunk around for in flight upgrades and
+	// last releases.
+	const int32 LiveChunks = FMath::DivideAndRoundUp(NodeIndexPool.GetHighWaterMark(), ChunkType::NodeCount);
+	if (LiveChunks < NodeChunks.Num())
+	{
+		NodeChunks.SetNum(LiveChunks);
+	}
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::Touch(ChunkType& Chunk, int32 Slot)
+{
+	if (IsDeferringTouches())
+	{
+		// Already queued, the pending touch reconciles the latest ref count
+		std::atomic<bool>& TouchPending = Chunk.TouchPending[Slot];
+		if (TouchPending.load(std::memory_order_relaxed)) return;
+		if (TouchPending.exchange(true, std::memory_order_acq_rel)) return;
+
+		DeferTouch(Chunk, Slot);
+		return;
+	}
+
+	FScopeLock Lock(Mutex);
+	ReconcileLocked(Chunk.FirstNodeIndex + Slot);
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::DeferTouch(ChunkType& Chunk, int32 Slot)
+{
+	const int32 NodeIndex = Chunk.FirstNodeIndex + Slot;
+	// Thread ids are often aligned, so they are spread with a Fibonacci hash
+	const uint32 Hash = FPlatformTLS::GetCurrentThreadId() * 0x9E3779B9u;
+	const int32 Shard = TouchShift < 32 ? int32(Hash >> TouchShift) : 0;
+	if (TouchBuffers[Shard].Push(NodeIndex)) return;
+
+	// Shard is full, so drain everything and fall back to a locked relink
+	FScopeLock Lock(Mutex);
+	FlushTouchesLocked();
+	Chunk.TouchPending[Slot].store(false, std::memory_order_release);
+	ReconcileLocked(NodeIndex);
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::FlushTouchesLocked()
+{
+	// Shards are drained one after another, so recency across threads is approximate. Each run
+	// of queued nodes is claimed with a single CAS.
+	TArray<int32, TInlineAllocator<64>> Drained;
+	for (FTextureAtlasTouchBuffer& Buffer : TouchBuffers)
+	{
+		while (Buffer.PopN(64, Drained) > 0)
+		{
+			for (const int32 NodeIndex : Drained)
+			{
+				GetChunk(NodeIndex).TouchPending[GetSlot(NodeIndex)].store(false, std::memory_order_release);
+				ReconcileLocked(NodeIndex);
+			}
+			Drained.Reset();
+		}
+	}
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::ReconcileLocked(int32 NodeIndex)
+{
+	ChunkType& Chunk = GetChunk(NodeIndex);
+	const int32 Slot = GetSlot(NodeIndex);
+
+	// Node may have been retired since it was touched
+	if (Chunk.Freed[Slot]) return;
+
+	// Both transitions reconcile against the live count, so racing hooks settle on the last one
+	const bool bWasReferenced = !IsLinkedLocked(NodeIndex);
+	UnlinkLocked(NodeIndex);
+
+	const bool bReferenced = Chunk.RefCounts[Slot].GetRefCount() != 0;
+	if (!bReferenced) LinkTailLocked(NodeIndex);
+
+	if (bReferenced != bWasReferenced && OnTouched) OnTouched(Chunk.Values[Slot], bReferenced);
+}
+
+template <typename ValueType>
+bool TTextureAtlasNodes<ValueType>::IsLinkedLocked(int32 NodeIndex) const
+{
+	// Only the head has no previous node
+	return LRUHead == NodeIndex || GetChunk(NodeIndex).Prev[GetSlot(NodeIndex)] != INDEX_NONE;
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::LinkTailLocked(int32 NodeIndex)
+{
+	check(!IsLinkedLocked(NodeIndex));
+
+	ChunkType& Chunk = GetChunk(NodeIndex);
+	const int32 Slot = GetSlot(NodeIndex);
+	Chunk.Prev[Slot] = LRUTail;
+	Chunk.Next[Slot] = INDEX_NONE;
+
+	if (LRUTail != INDEX_NONE) GetChunk(LRUTail).Next[GetSlot(LRUTail)] = NodeIndex;
+	else LRUHead = NodeIndex;
+	LRUTail = NodeIndex;
+}
+
+template <typename ValueType>
+void TTextureAtlasNodes<ValueType>::UnlinkLocked(int32 NodeIndex)
+{
+	if (!IsLinkedLocked(NodeIndex)) return;
+
+	ChunkType& Chunk = GetChunk(NodeIndex);
+	const int32 Slot = GetSlot(NodeIndex);
+
+	const int32 Prev = Chunk.Prev[Slot];
+	const int32 Next = Chunk.Next[Slot];
+
+	if (Prev != INDEX_NONE) GetChunk(Prev).Next[GetSlot(Prev)] = Next;
+	else LRUHead = Next;
+
+	if (Next != INDEX_NONE) GetChunk(Next).Prev[GetSlot(Next)] = Prev;
+	else LRUTail = Prev;
+
+	Chunk.Prev[Slot] = INDEX_NONE;
+	Chunk.Next[Slot] = INDEX_NONE;
+}